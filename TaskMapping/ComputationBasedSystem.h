@@ -2,7 +2,8 @@
 
 #include "System.h"
 
-class ComputationBasedSystem : public System {
+// Final, so calls through a ComputationBasedSystem are resolved at compile time, see CostTable
+class ComputationBasedSystem final : public System {
 public:
 	ComputationBasedSystem(TaskGraph&& t, Platform&& p) : task_graph(std::move(t)), platform(std::move(p)) {};
 	void replace_graph(TaskGraph&& g) {
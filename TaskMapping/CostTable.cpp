@@ -0,0 +1,53 @@
+#include "CostTable.h"
+#include "ComputationBasedSystem.h"
+
+CostTable::CostTable(System const& sys) :
+	nbr_procs(sys.get_platform().get_processors().size()),
+	nbr_mems(sys.get_platform().get_memories().size())
+{
+	if (ComputationBasedSystem const* computation_based = dynamic_cast<ComputationBasedSystem const*>(&sys)) {
+		fill(*computation_based);
+	}
+	else {
+		fill(sys);
+	}
+}
+
+template <class SystemType>
+void CostTable::fill(SystemType const& sys) {
+	FrozenTaskGraph const& graph = sys.get_task_graph().freeze();
+	std::vector<Processor*> const& processors = sys.get_platform().get_processors();
+	std::vector<Memory*> const& memories = sys.get_platform().get_memories();
+
+	compatible.reserve(graph.nbr_tasks() * nbr_procs);
+	computation.reserve(graph.nbr_tasks() * nbr_procs);
+	input.reserve(graph.nbr_tasks() * nbr_mems * nbr_procs);
+	output.reserve(graph.nbr_tasks() * nbr_procs * nbr_mems);
+	edge_transfer.reserve(graph.nbr_edges() * nbr_mems * nbr_mems);
+
+	for (Task* task : graph.get_tasks()) {
+		for (Processor* proc : processors) {
+			compatible.push_back(sys.is_compatible(task, proc));
+			computation.push_back(sys.computation_time_ms(task, proc));
+		}
+		for (Memory* mem : memories) {
+			for (Processor* proc : processors) {
+				input.push_back(sys.transaction_time_ms(graph.get_input_size(task->get_id()), mem, proc));
+			}
+		}
+		for (Processor* proc : processors) {
+			for (Memory* mem : memories) {
+				output.push_back(sys.transaction_time_ms(graph.get_output_size(task->get_id()), proc, mem));
+			}
+		}
+	}
+
+	for (EdgeId edge = 0; edge < graph.nbr_edges(); ++edge) {
+		DataSize const size = graph.get_output_size(graph.get_edge_src(edge));
+		for (Memory* mem_out : memories) {
+			for (Memory* mem_in : memories) {
+				edge_transfer.push_back(sys.transaction_time_ms(size, mem_out, mem_in));
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "System.h"
+#include "FrozenTaskGraph.h"
+
+#include <vector>
+
+// Computation and transfer times of all tasks and edges on all devices, precomputed once through the System interface.
+// Devices are addressed by their kind-local index (see Device::get_index()), all tables are flat and row-major.
+// For a ComputationBasedSystem the table is filled through the final type, so the System calls inline.
+class CostTable {
+public:
+	CostTable(System const& sys);
+
+	size_t nbr_processors() const { return nbr_procs; }
+	size_t nbr_memories() const { return nbr_mems; }
+
+	bool is_compatible(TaskId task, size_t proc) const { return compatible[task * nbr_procs + proc]; }
+	Time computation_time(TaskId task, size_t proc) const { return computation[task * nbr_procs + proc]; }
+	// Transfer of the task input from mem to proc
+	Time input_time(TaskId task, size_t mem, size_t proc) const { return input[(task * nbr_mems + mem) * nbr_procs + proc]; }
+	// Transfer of the task output from proc to mem
+	Time output_time(TaskId task, size_t proc, size_t mem) const { return output[(task * nbr_procs + proc) * nbr_mems + mem]; }
+	// Transfer of the edge data from the output memory of the source to the input memory of the sink
+	Time edge_time(EdgeId edge, size_t mem_out, size_t mem_in) const { return edge_transfer[(edge * nbr_mems + mem_out) * nbr_mems + mem_in]; }
+
+	bool is_compatible(Task* task, Processor const* proc) const { return is_compatible(task->get_id(), proc->get_index()); }
+	Time computation_time(Task* task, Processor const* proc) const { return computation_time(task->get_id(), proc->get_index()); }
+	Time input_time(Task* task, Memory const* mem, Processor const* proc) const { return input_time(task->get_id(), mem->get_index(), proc->get_index()); }
+	Time output_time(Task* task, Processor const* proc, Memory const* mem) const { return output_time(task->get_id(), proc->get_index(), mem->get_index()); }
+	Time edge_time(Edge* edge, Memory const* mem_out, Memory const* mem_in) const { return edge_time(edge->get_id(), mem_out->get_index(), mem_in->get_index()); }
+
+private:
+	// Defined in CostTable.cpp, which only uses it for System and ComputationBasedSystem
+	template <class SystemType>
+	void fill(SystemType const& sys);
+
+	size_t nbr_procs;
+	size_t nbr_mems;
+
+	std::vector<char> compatible;
+	std::vector<Time> computation;
+	std::vector<Time> input;
+	std::vector<Time> output;
+	std::vector<Time> edge_transfer;
+};
\ No newline at end of file
@@ -8,12 +8,12 @@ template <class Policies> class DecompositionMapper : public Mapper {
 	Mapper* base_mapper;
 
 protected:
-	virtual Decomposition create_decomposition(TaskGraph const& task_graph) const = 0;
+	virtual Decomposition create_decomposition(FrozenTaskGraph const& task_graph) const = 0;
 
 public:
 	Mapping get_task_mapping(System const& sys) const {
 		std::vector<DevicePair> device_pairs = device_pairs_from_platform(sys.get_platform());
-		Decomposition decomposition = create_decomposition(sys.get_task_graph());
+		Decomposition decomposition = create_decomposition(sys.get_task_graph().freeze());
 
 		Mapping mapping = Policies::BaseMappingPolicy::create_base_mapping(sys);
 		Policies::EvaluationPolicy::adapt_mapping(mapping, sys, device_pairs, decomposition);
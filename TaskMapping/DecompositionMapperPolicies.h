@@ -7,6 +7,9 @@
 #include "MappingUtility.h"
 #include "GreedyMapper.h"
 #include "Evaluation.h"
+#include "IncrementalEvaluation.h"
+#include "LowerBound.h"
+#include "EvaluatorPool.h"
 
 #include <iomanip>
 
@@ -28,20 +31,93 @@ protected:
 		}
 		return change;
 	}
+
+	struct Move {
+		DevicePair const* dev_pair;
+		SubGraphSet const* subgraph;
+	};
+
+	// Evaluates moves of subgraphs relative to the current mapping on all threads of a pool. Every worker has its
+	// own IncrementalEvaluator and LowerBoundEvaluator, which are synchronized with the mapping when the worker first
+	// uses them after a change.
+	class MoveEvaluator {
+		System const& sys;
+		Mapping const& mapping;
+		EvaluatorPool pool;
+		std::vector<std::unique_ptr<IncrementalEvaluator>> inc_evals; // By worker
+		std::vector<std::unique_ptr<LowerBoundEvaluator>> bound_evals; // By worker
+		std::vector<size_t> synced_version; // By worker
+		std::vector<size_t> bound_synced_version; // By worker
+		size_t version = 0;
+		Time cost;
+
+	public:
+		static constexpr Time PRUNED = std::numeric_limits<Time>::infinity();
+
+		MoveEvaluator(System const& sys, Mapping const& mapping) : sys(sys), mapping(mapping), pool(sys), synced_version(pool.size(), 0), bound_synced_version(pool.size(), 0) {
+			for (size_t worker = 0; worker < pool.size(); ++worker) {
+				inc_evals.push_back(std::make_unique<IncrementalEvaluator>(pool.get_evaluator(worker)));
+				bound_evals.push_back(std::make_unique<LowerBoundEvaluator>(pool.get_context()));
+			}
+			cost = inc_evals[0]->set_base(mapping);
+			synced_version[0] = ++version;
+		}
+
+		Time get_cost() const { return cost; }
+
+		// Has to be called after each change of the mapping
+		void update() {
+			cost = inc_evals[0]->set_base(mapping);
+			synced_version[0] = ++version;
+		}
+
+		// Applies the move to moved_mapping and returns its cost, -1 if the move does not change the mapping.
+		// Returns PRUNED without simulation if a lower bound of the cost is at least prune_at.
+		Time evaluate(Move const& move, MappingView& moved_mapping, size_t worker = 0, Time prune_at = PRUNED) {
+			if (!map_subgraph(sys, *move.subgraph, *move.dev_pair, moved_mapping)) {
+				return -1;
+			}
+			if (prune_at < PRUNED) {
+				if (bound_synced_version[worker] != version) {
+					bound_evals[worker]->set_base(mapping);
+					bound_synced_version[worker] = version;
+				}
+				if (bound_evals[worker]->compute_bound(moved_mapping, moved_mapping.get_mapped_tasks()) >= prune_at) {
+					return PRUNED;
+				}
+			}
+			if (synced_version[worker] != version) {
+				inc_evals[worker]->set_base(mapping);
+				synced_version[worker] = version;
+			}
+			return inc_evals[worker]->compute_cost(moved_mapping, moved_mapping.get_mapped_tasks());
+		}
+
+		// Costs of all moves, evaluated in parallel, see evaluate(Move const&, ...)
+		std::vector<Time> evaluate(std::vector<Move> const& moves, Time prune_at = PRUNED) {
+			std::vector<Time> costs(moves.size());
+			pool.parallel_for(moves.size(), [&](size_t i, size_t worker) {
+				MappingView moved_mapping(&mapping);
+				costs[i] = evaluate(moves[i], moved_mapping, worker, prune_at);
+			});
+			return costs;
+		}
+	};
 };
 
 class EvaluateAll : EvaluationPolicyBase {
 public:
 	static void adapt_mapping(Mapping& mapping, System const& sys, std::vector<DevicePair> const& device_pairs, Decomposition const& decomposition) {
-		MappingEvaluator eval(sys);
-		Time cost = eval.compute_cost(mapping);
+		MoveEvaluator move_eval(sys, mapping);
+		Time cost = move_eval.get_cost();
 		bool change;
 
+		FrozenTaskGraph const& task_graph = sys.get_task_graph().freeze();
 		std::unordered_map<SubGraphSet const*, Area> areas;
 		for (SubGraphSet const& subgraph : decomposition) {
 			Area area = 0;
 			for (Task* task : subgraph) {
-				area += task->get_area_requirement();
+				area += task_graph.get_area_requirement(task->get_id());
 			}
 			areas[&subgraph] = area;
 		}
@@ -57,46 +133,56 @@ public:
 #ifndef NOLOG
 		size_t it_count = 0;
 		size_t computed_mapping_count = 0;
+		size_t pruned_mapping_count = 0;
 #endif
+		std::vector<Move> moves;
 		do {
 			change = false;
-			MappingView best_mapping;
 			Time best_cost = cost;
-			Processor const* best_proc = nullptr;
-			Area best_area = 0;
+			Move const* best_move = nullptr;
 
+			moves.clear();
 			for (DevicePair const& dev_pair : device_pairs) {
 				for (SubGraphSet const& subgraph : decomposition) {
 					if (!dev_pair.get_proc()->has_maximum_capacity() || areas[&subgraph] < remaining_area[dev_pair.get_proc()])
 					{
-						MappingView current_mapping(&mapping);
-						if (map_subgraph(sys, subgraph, dev_pair, current_mapping)) {
-							Time curr_cost = eval.compute_cost(current_mapping);
+						moves.push_back({ &dev_pair, &subgraph });
+					}
+				}
+			}
 
+			// Selected in the original order, the result does not depend on the number of threads.
+			// Moves that cannot beat the current cost are pruned by their lower bound.
+			std::vector<Time> const costs = move_eval.evaluate(moves, cost);
+			for (size_t i = 0; i < moves.size(); ++i) {
+				if (costs[i] < 0) {
+					continue;
+				}
 #ifndef NOLOG
-							++computed_mapping_count;
+				if (costs[i] == MoveEvaluator::PRUNED) {
+					++pruned_mapping_count;
+					continue;
+				}
+				++computed_mapping_count;
 #endif
-
-							if (curr_cost < best_cost) {
-								best_cost = curr_cost;
-								best_mapping = std::move(current_mapping);
-								best_proc = dev_pair.get_proc();
-								best_area = areas[&subgraph];
-								change = true;
-							}
-						}
-					}
+				if (costs[i] < best_cost) {
+					best_cost = costs[i];
+					best_move = &moves[i];
+					change = true;
 				}
 			}
 
 			if (change) {
 #ifndef NOLOG
-				std::cout << "Iteration " << std::left << std::setw(4) << ++it_count << " Solution improved! New cost: " << std::setw(5) << best_cost << " Computed mappings: " << computed_mapping_count << std::endl;
+				std::cout << "Iteration " << std::left << std::setw(4) << ++it_count << " Solution improved! New cost: " << std::setw(5) << best_cost << " Computed mappings: " << computed_mapping_count << " Pruned mappings: " << pruned_mapping_count << std::endl;
 #endif
-				best_mapping.apply(mapping);
+				map_subgraph(sys, *best_move->subgraph, *best_move->dev_pair, mapping);
+				move_eval.update();
 				cost = best_cost;
 
-				assert(best_proc);
+				Processor const* const best_proc = best_move->dev_pair->get_proc();
+				Area const best_area = areas[best_move->subgraph];
+
 				if (best_proc->has_maximum_capacity()) {
 					// Leads to one-way mapping, area cannot be "freed" again after it has been mapped once.
 					remaining_area[best_proc] -= best_area;
@@ -109,8 +195,8 @@ public:
 template <int THRESHOLD_TIMES_TEN> class EvaluateThreshold : EvaluationPolicyBase {
 public:
 	static void adapt_mapping(Mapping& mapping, System const& sys, std::vector<DevicePair> const& device_pairs, Decomposition const& decomposition) {
-		MappingEvaluator eval(sys);
-		Time cost = eval.compute_cost(mapping);
+		MoveEvaluator move_eval(sys, mapping);
+		Time cost = move_eval.get_cost();
 
 		struct QueueElement {
 			Time time_diff;
@@ -129,44 +215,51 @@ public:
 		size_t computed_mapping_count = 0;
 #endif
 
+		FrozenTaskGraph const& task_graph = sys.get_task_graph().freeze();
 		std::priority_queue<QueueElement> effect_queue;
 		std::unordered_map<SubGraphSet const*, Area> areas;
 
-		MappingView best_mapping;
-		Processor const* best_proc = nullptr;
-		Area best_area = 0;
-		Time best_cost = cost;
+		std::vector<Move> moves;
 		for (SubGraphSet const& subgraph : decomposition) {
 			Area area = 0;
 			for (Task* task : subgraph) {
-				area += task->get_area_requirement();
+				area += task_graph.get_area_requirement(task->get_id());
 			}
 			areas[&subgraph] = area;
 
 			for (DevicePair const& dev_pair : device_pairs) {
 				if (!dev_pair.get_proc()->has_maximum_capacity() || area <= dev_pair.get_proc()->get_maximum_capacity()) {
-					MappingView current_mapping(&mapping);
-					if (map_subgraph(sys, subgraph, dev_pair, current_mapping)) {
-						Time curr_cost = eval.compute_cost(current_mapping);
-						Time cost_diff = cost - curr_cost;
+					moves.push_back({ &dev_pair, &subgraph });
+				}
+			}
+		}
 
+		// The initial effects of all moves are evaluated in parallel, the updates below depend on each other
+		MappingView best_mapping;
+		Processor const* best_proc = nullptr;
+		Area best_area = 0;
+		Time best_cost = cost;
+		Move const* best_move = nullptr;
+		std::vector<Time> const costs = move_eval.evaluate(moves);
+		for (size_t i = 0; i < moves.size(); ++i) {
+			if (costs[i] < 0) {
+				effect_queue.push({ 0, moves[i].dev_pair, moves[i].subgraph });
+				continue;
+			}
 #ifndef NOLOG
-						++computed_mapping_count;
+			++computed_mapping_count;
 #endif
-
-						if (curr_cost < best_cost) {
-							best_cost = curr_cost;
-							best_mapping = std::move(current_mapping);
-							best_proc = dev_pair.get_proc();
-							best_area = area;
-						}
-						effect_queue.push({ cost_diff, &dev_pair, &subgraph });
-					}
-					else {
-						effect_queue.push({ 0, &dev_pair, &subgraph });
-					}
-				}
+			if (costs[i] < best_cost) {
+				best_cost = costs[i];
+				best_move = &moves[i];
 			}
+			effect_queue.push({ cost - costs[i], moves[i].dev_pair, moves[i].subgraph });
+		}
+		if (best_move) {
+			best_mapping.reset(&mapping);
+			map_subgraph(sys, *best_move->subgraph, *best_move->dev_pair, best_mapping);
+			best_proc = best_move->dev_pair->get_proc();
+			best_area = areas[best_move->subgraph];
 		}
 
 		std::unordered_map<Processor const*, Area> remaining_area;
@@ -183,6 +276,7 @@ public:
 			std::cout << "Iteration " << std::left << std::setw(4) << ++it_count << " Solution improved! New cost: " << std::setw(5) << best_cost << " Computed mappings: " << computed_mapping_count << std::endl;
 #endif
 			best_mapping.apply(mapping);
+			move_eval.update();
 			cost = best_cost;
 			assert(best_proc);
 			if (best_proc->has_maximum_capacity()) {
@@ -205,9 +299,10 @@ public:
 				Time cost_diff = std::numeric_limits<Time>::min();
 				if (!element.dev_pair->get_proc()->has_maximum_capacity() || areas[element.subgraph] <= remaining_area[element.dev_pair->get_proc()]) {
 					MappingView current_mapping(&mapping);
-					map_subgraph(sys, *element.subgraph, *element.dev_pair, current_mapping);
-
-					Time curr_cost = eval.compute_cost(current_mapping);
+					Time curr_cost = move_eval.evaluate({ element.dev_pair, element.subgraph }, current_mapping);
+					if (curr_cost < 0) {
+						curr_cost = cost; // Nothing changes
+					}
 					cost_diff = cost - curr_cost;
 
 #ifndef NOLOG
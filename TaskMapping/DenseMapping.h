@@ -0,0 +1,100 @@
+#pragma once
+
+#include "System.h"
+#include "Mapping.h"
+#include "FrozenTaskGraph.h"
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+typedef std::uint8_t DeviceIndex;
+
+// Compact mapping storing the device indices (see Device::get_index()) in contiguous arrays indexed by task id.
+// Lookups do not hash and copies are a memcpy of three bytes per task plus the used area by processor.
+class DenseMapping {
+public:
+	static DeviceIndex constexpr NO_DEVICE = std::numeric_limits<DeviceIndex>::max();
+
+	DenseMapping() = default;
+
+	DenseMapping(System const& sys) :
+		platform(&sys.get_platform()),
+		graph(&sys.get_task_graph().freeze()),
+		used_area(sys.get_platform().get_processors().size(), 0),
+		processors(sys.get_task_graph().get_tasks().size(), NO_DEVICE),
+		memories_in(sys.get_task_graph().get_tasks().size(), NO_DEVICE),
+		memories_out(sys.get_task_graph().get_tasks().size(), NO_DEVICE)
+	{
+		assert(sys.get_platform().get_processors().size() < NO_DEVICE && sys.get_platform().get_memories().size() < NO_DEVICE);
+	}
+
+	DenseMapping(Mapping const& mapping, System const& sys) : DenseMapping(sys) {
+		for (Task* task : sys.get_task_graph().get_tasks()) {
+			if (mapping.contains(task)) {
+				map(task, mapping.get_processor(task), mapping.get_mem_in(task), mapping.get_mem_out(task));
+			}
+		}
+	}
+
+	void map(TaskId task, DeviceIndex processor, DeviceIndex mem_in, DeviceIndex mem_out) {
+		if (processors[task] != NO_DEVICE) {
+			hash ^= assignment_key(task, processors[task], memories_in[task], memories_out[task]);
+			used_area[processors[task]] -= graph->get_area_requirement(task);
+		}
+		if (processor != NO_DEVICE) {
+			hash ^= assignment_key(task, processor, mem_in, mem_out);
+			used_area[processor] += graph->get_area_requirement(task);
+		}
+		processors[task] = processor;
+		memories_in[task] = mem_in;
+		memories_out[task] = mem_out;
+	}
+
+	void map(Task* task, Processor const* processor, Memory const* mem_in, Memory const* mem_out) {
+		map(task->get_id(), index_of(processor), index_of(mem_in), index_of(mem_out));
+	}
+
+	void map(Task* task, Processor const* processor) {
+		map(task, processor, processor->get_default_memory(), processor->get_default_memory());
+	}
+
+	size_t size() const { return processors.size(); }
+	// Same as Mapping::get_hash of an equal Mapping
+	std::uint64_t get_hash() const { return hash; }
+	// Summed area requirement of the tasks mapped to the processor, kept up to date by map
+	Area get_used_area(Processor const* processor) const { return used_area[processor->get_index()]; }
+
+	bool contains(Task* task) const { return processors[task->get_id()] != NO_DEVICE; }
+	Processor const* get_processor(Task* task) const { return processor_at(processors[task->get_id()]); }
+	Memory const* get_mem_in(Task* task) const { return memory_at(memories_in[task->get_id()]); }
+	Memory const* get_mem_out(Task* task) const { return memory_at(memories_out[task->get_id()]); }
+
+	DeviceIndex get_processor_index(TaskId task) const { return processors[task]; }
+	DeviceIndex get_mem_in_index(TaskId task) const { return memories_in[task]; }
+	DeviceIndex get_mem_out_index(TaskId task) const { return memories_out[task]; }
+
+	Mapping to_mapping(FrozenTaskGraph const& task_graph) const {
+		Mapping mapping;
+		for (Task* task : task_graph.get_tasks()) {
+			if (contains(task)) {
+				mapping.map(task, get_processor(task), get_mem_in(task), get_mem_out(task));
+			}
+		}
+		return mapping;
+	}
+
+private:
+	static DeviceIndex index_of(Device const* device) { return device ? static_cast<DeviceIndex>(device->get_index()) : NO_DEVICE; }
+	Processor const* processor_at(DeviceIndex idx) const { return idx == NO_DEVICE ? nullptr : platform->get_processors()[idx]; }
+	Memory const* memory_at(DeviceIndex idx) const { return idx == NO_DEVICE ? nullptr : platform->get_memories()[idx]; }
+
+	Platform const* platform = nullptr;
+	FrozenTaskGraph const* graph = nullptr;
+	std::vector<Area> used_area; // By processor index
+	std::vector<DeviceIndex> processors;
+	std::vector<DeviceIndex> memories_in;
+	std::vector<DeviceIndex> memories_out;
+	std::uint64_t hash = 0;
+};
\ No newline at end of file
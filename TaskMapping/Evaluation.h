@@ -2,36 +2,112 @@
 
 #include "System.h"
 #include "Mapping.h"
+#include "DenseMapping.h"
+#include "CostTable.h"
 #include "TopologicalSorting.h"
+#include "EventSimulation.h"
 #include "EvaluationLog.h"
+#include "EvaluationCache.h"
+#include "Parallel.h"
 
 #include <unordered_map>
+#include <memory>
+#include <bit>
+#include <random>
+#include <atomic>
+#include <span>
+#include <cassert>
+#include <array>
+#include <type_traits>
 #include <iostream>
 
-enum class SORTING_MODE { RANDOM, BREADTH_FIRST_SEARCH, TASK_FIRST_BFS, MAPPING_BASED };
+// EVENT_DRIVEN simulates the mapping with the EventSimulator instead of evaluating a sorting
+enum class SORTING_MODE { RANDOM, BREADTH_FIRST_SEARCH, TASK_FIRST_BFS, MAPPING_BASED, RANK_BASED, EVENT_DRIVEN };
 
+// Read-only part of the evaluation: cost table and the mapping independent sortings, plus the cache of evaluated costs.
+// Built once and shared by any number of MappingEvaluators, also across threads.
+class EvaluationContext {
+	System const& sys;
+	FrozenTaskGraph const& graph;
+	CostTable const costs;
+	BFSSorting const bfs_sorting;
+	TaskFirstBFSSorting const task_first_bfs_sorting;
+	mutable EvaluationCache cache; // Thread-safe
+
+public:
+	EvaluationContext(System const& sys, size_t cache_capacity = EvaluationCache::DEFAULT_CAPACITY) :
+		sys(sys), graph(sys.get_task_graph().freeze()), costs(sys), bfs_sorting(graph), task_first_bfs_sorting(graph), cache(cache_capacity) {}
+
+	System const& get_sys() const { return sys; }
+	FrozenTaskGraph const& get_graph() const { return graph; }
+	CostTable const& get_costs() const { return costs; }
+	EvaluationCache& get_cache() const { return cache; }
+
+	// Uncompressed sorting of a mapping independent mode, nullptr for RANDOM and the mapping dependent modes
+	TopologicalSorting const* get_sorting(SORTING_MODE mode) const {
+		switch (mode) {
+			case SORTING_MODE::BREADTH_FIRST_SEARCH:
+				return &bfs_sorting;
+			case SORTING_MODE::TASK_FIRST_BFS:
+				return &task_first_bfs_sorting;
+			default:
+				return nullptr;
+		}
+	}
+};
+
+// Simulates mappings on a shared EvaluationContext. The evaluator itself holds the mutable workspace (log, scratch buffers)
+// and must only be used by one thread at a time. Use one evaluator per thread, see EvaluatorPool.
 class MappingEvaluator {
+public:
+	static size_t constexpr BATCH_LANES = 8; // Mappings simulated side by side by compute_costs
+
+private:
+	std::shared_ptr<EvaluationContext const> context;
 	System const& sys;
+	FrozenTaskGraph const& graph;
+	CostTable const& costs;
+
+	// Workspace
 	mutable EvaluationLog log;
-	mutable TopologicalSorting* cached_sorting = nullptr;
-	mutable SORTING_MODE cached_mode = SORTING_MODE::TASK_FIRST_BFS;
+	mutable CachedSorting compressed_sorting; // Reused for compressed copies of the shared sortings
+	mutable std::vector<Time> device_times; // Indexed by Device::get_id(), reused by every simulation
+	mutable std::unique_ptr<EventSimulator> event_simulator; // Created on the first SORTING_MODE::EVENT_DRIVEN evaluation
+	mutable RandomSorting random_sorting; // Resampled by every random evaluation
+	mutable SortingWorkspace sorting_workspace;
+	mutable Xoshiro256 random_engine; // Of SORTING_MODE::RANDOM, see seed_random
+
+	// Workspace of compute_costs, structure of arrays with BATCH_LANES consecutive values per device, task or edge
+	struct BatchWorkspace {
+		std::vector<Time> device_times; // By Device::get_id()
+		std::vector<unsigned> processor, mem_in, mem_out; // Device::get_id() by task
+		std::vector<Time> computation, input, output; // By task
+		std::vector<Time> transfer; // By edge
+	};
+	mutable BatchWorkspace batch;
 	bool log_results;
 
-	void set_cache(TopologicalSorting const* sorting, SORTING_MODE const& mode) const {
-		if (cached_sorting) delete cached_sorting;
-		cached_sorting = new CachedSorting(sorting);
-		cached_mode = mode;
-	}
 public:
-	MappingEvaluator(System const& sys, bool log_results = false) : sys(sys), log_results(log_results) {}
-	~MappingEvaluator() { if (cached_sorting) delete cached_sorting; }
+	MappingEvaluator(System const& sys, bool log_results = false) : MappingEvaluator(std::make_shared<EvaluationContext const>(sys), log_results) {}
+	MappingEvaluator(std::shared_ptr<EvaluationContext const> context, bool log_results = false) :
+		context(std::move(context)), sys(this->context->get_sys()), graph(this->context->get_graph()), costs(this->context->get_costs()), log_results(log_results)
+	{
+		if (log_results) {
+			log = EvaluationLog(graph.nbr_tasks(), graph.nbr_edges());
+		}
+	}
 	
 	EvaluationLog const& get_log() const { return log; }
+	// Exchanges the log with other in O(1), e.g. to keep the log of the best of several evaluations
+	void swap_log(EvaluationLog& other) const { log.swap(other); }
 	System const& get_sys() const { return sys; }
+	CostTable const& get_costs() const { return costs; }
+	std::shared_ptr<EvaluationContext const> const& get_context() const { return context; }
 
-	bool is_compatible(Mapping const& mapping, Task** out_task = nullptr) const {
-		for (Task* task : sys.get_task_graph().get_tasks()) {
-			if (!sys.is_compatible(task, mapping.get_processor(task))) {
+	template <class MappingType>
+	bool is_compatible(MappingType const& mapping, Task** out_task = nullptr) const {
+		for (Task* task : graph.get_tasks()) {
+			if (!costs.is_compatible(task, mapping.get_processor(task))) {
 				if (out_task) *out_task = task;
 				return false;
 			}
@@ -39,8 +115,9 @@ public:
 		return true;
 	}
 
-	bool is_complete(Mapping const& mapping, Task** out_task = nullptr) const {
-		for (Task* task : sys.get_task_graph().get_tasks()) {
+	template <class MappingType>
+	bool is_complete(MappingType const& mapping, Task** out_task = nullptr) const {
+		for (Task* task : graph.get_tasks()) {
 			if (!mapping.get_processor(task) || !mapping.get_mem_in(task) || !mapping.get_mem_out(task)) {
 				if (out_task) *out_task = task;
 				return false;
@@ -49,138 +126,212 @@ public:
 		return true;
 	}
 
-	bool satisfies_capacity_constraint(Mapping const& mapping, Processor const** out_proc = nullptr) const {
+	// O(P) with the used area the mapping keeps by processor
+	template <class MappingType>
+	bool satisfies_capacity_constraint(MappingType const& mapping, Processor const** out_proc = nullptr) const {
 		for (Processor const* processor : sys.get_platform().get_processors()) {
-			Area capacity = processor->get_maximum_capacity();
-			if (capacity < std::numeric_limits<Area>::infinity()) {
-				for (Task* task : sys.get_task_graph().get_tasks()) {
-					if (mapping.get_processor(task) == processor) {
-						capacity -= task->get_area_requirement();
-					}
-				}
-				if (capacity < 0) {
-					if (out_proc) *out_proc = processor;
-					return false;
-				}
+			if (mapping.get_used_area(processor) > processor->get_maximum_capacity()) {
+				if (out_proc) *out_proc = processor;
+				return false;
 			}
 		}
 		return true;
 	}
 
-	Time compute_cost(Mapping const& mapping, SORTING_MODE mode = SORTING_MODE::TASK_FIRST_BFS) const {
+	// Restarts the engine of SORTING_MODE::RANDOM, which is seeded with 0 on construction
+	void seed_random(std::uint64_t seed) const { random_engine.seed(seed); }
 
-        TopologicalSorting* sorting;
+	// Hits and misses of the cache of the shared context
+	EvaluationCache::Statistics get_cache_statistics() const { return context->get_cache().get_statistics(); }
 
-		if (cached_sorting && cached_mode == mode) {
-			sorting = new CachedSorting(cached_sorting);
+	// Accepts Mapping, MappingView and DenseMapping. Costs of the deterministic modes are cached by the hash of the
+	// mapping in the context, unless the evaluator logs its results.
+	template <class MappingType>
+	Time compute_cost(MappingType const& mapping, SORTING_MODE mode = SORTING_MODE::TASK_FIRST_BFS) const {
+		if (mode == SORTING_MODE::RANDOM) {
+			return compute_cost_random(mapping, random_engine);
 		}
-		else {
-			switch (mode) {
-				case SORTING_MODE::RANDOM:
-					sorting = new RandomSorting(sys.get_task_graph());
-					break;
-				case SORTING_MODE::TASK_FIRST_BFS:
-					sorting = new TaskFirstBFSSorting(sys.get_task_graph());
-					set_cache(sorting, mode);
-					break;
-				case SORTING_MODE::MAPPING_BASED:
-					sorting = new MappingBasedSorting(sys, mapping);
-					break;
-				case SORTING_MODE::BREADTH_FIRST_SEARCH:
-					[[fallthrough]];
-				default:
-					sorting = new BFSSorting(sys.get_task_graph());
-					set_cache(sorting, mode);
-			}
+		if (log_results) {
+			return compute_cost_uncached(mapping, mode);
 		}
-
-		for (Processor* proc : sys.get_platform().get_processors()) {
-			if (proc->is_streaming_device()) {
-				for (Task* task : sys.get_task_graph().get_tasks()) {
-					if (mapping.get_processor(task) == proc) {
-						sorting->compress_streamable_subtrees(mapping, proc);
-						break;
-					}
-				}
-			}
+		std::uint64_t const key = EvaluationCache::key(mapping.get_hash(), static_cast<unsigned>(mode));
+		Time cost;
+		if (!context->get_cache().lookup(key, cost)) {
+			cost = compute_cost_uncached(mapping, mode);
+			context->get_cache().store(key, cost);
 		}
+		return cost;
+	}
 
-		Time result = compute_cost_with_sorting(mapping, *sorting);
+	// Cost with a random sorting drawn from rng instead of the engine of SORTING_MODE::RANDOM
+	template <class MappingType>
+	Time compute_cost(MappingType const& mapping, std::mt19937& rng) const {
+		return compute_cost_random(mapping, rng);
+	}
 
-        delete sorting;
-        sorting = nullptr;
+	template <class MappingType>
+	Time compute_cost(MappingType const& mapping, Xoshiro256& rng) const {
+		return compute_cost_random(mapping, rng);
+	}
 
-		return result;
+	// Cost with an uncompressed sorting, compressed for the mapping like the sortings of compute_cost
+	template <class MappingType>
+	Time compute_cost(MappingType const& mapping, TopologicalSorting const& sorting) const {
+		return compute_cost_compressed(mapping, &sorting, nullptr);
 	}
 
-	Time compute_cost_with_sorting(Mapping const& mapping, TopologicalSorting const& sorting) const {
-		std::vector<GraphElement> const& sorted_elements = sorting.get_sorted_elements();
+	template <class MappingType>
+	Time compute_cost_with_sorting(MappingType const& mapping, TopologicalSorting const& sorting) const {
+		return log_results ? simulate_sorting<true>(mapping, sorting) : simulate_sorting<false>(mapping, sorting);
+	}
 
-		std::unordered_map<Device const*, Time> time;
-		for (Processor* proc : sys.get_platform().get_processors()) {
-			time[proc] = 0;
+	// Costs of several mappings, walking the shared sorting of mode once per BATCH_LANES mappings. Mappings that need
+	// streaming compression and mapping dependent modes fall back to compute_cost. Results are identical to compute_cost
+	// and share its cache, the log is only written by the fallback.
+	template <class MappingType>
+	std::vector<Time> compute_costs(std::span<MappingType const> mappings, SORTING_MODE mode = SORTING_MODE::TASK_FIRST_BFS) const {
+		std::vector<Time> result(mappings.size());
+		TopologicalSorting const* sorting = context->get_sorting(mode);
+
+		EvaluationCache& cache = context->get_cache();
+		auto const key = [&](size_t i) { return EvaluationCache::key(mappings[i].get_hash(), static_cast<unsigned>(mode)); };
+		auto const compute_lanes = [&](std::vector<size_t> const& lanes) {
+			compute_batch(mappings, lanes, *sorting, result);
+			for (size_t i : lanes) {
+				cache.store(key(i), result[i]);
+			}
+		};
+
+		std::vector<size_t> lanes; // Indices of the mappings in the current batch
+		for (size_t i = 0; i < mappings.size(); ++i) {
+			if (!sorting || log_results || needs_compression(mappings[i])) {
+				result[i] = compute_cost(mappings[i], mode);
+				continue;
+			}
+			if (cache.lookup(key(i), result[i])) {
+				continue;
+			}
+			lanes.push_back(i);
+			if (lanes.size() == BATCH_LANES) {
+				compute_lanes(lanes);
+				lanes.clear();
+			}
+		}
+		if (!lanes.empty()) {
+			compute_lanes(lanes);
 		}
-		for (Memory* mem : sys.get_platform().get_memories()) {
-			time[mem] = 0;
+		return result;
+	}
+
+	// Schedules one element as early as its devices allow and advances their ready times (indexed by Device::get_id()). Returns start and end time.
+	template <class MappingType>
+	std::pair<Time, Time> simulate_element(GraphElement const& element, MappingType const& mapping, std::vector<Time>& time) const {
+		Task* next_task = element.get_task();
+		if (next_task) {
+			Processor const* processor = mapping.get_processor(next_task);
+			Memory const* mem_in = mapping.get_mem_in(next_task);
+			Memory const* mem_out = mapping.get_mem_out(next_task);
+
+			Time const t_start = std::max({ time[processor->get_id()], time[mem_in->get_id()], time[mem_out->get_id()] });
+			Time const t_end = t_start + costs.computation_time(next_task, processor) + costs.input_time(next_task, mem_in, processor) + costs.output_time(next_task, processor, mem_out);
+			time[processor->get_id()] = t_end;
+			time[mem_in->get_id()] = t_end;
+			time[mem_out->get_id()] = t_end;
+			return { t_start, t_end };
 		}
 
-		for (GraphElement element : sorted_elements) {
-			Task* next_task = element.get_task();
-			if (next_task) {
-				Processor const* processor = mapping.get_processor(next_task);
-				Memory const* mem_in = mapping.get_mem_in(next_task);
-				Memory const* mem_out = mapping.get_mem_out(next_task);
+		Edge* next_edge = element.get_edge();
+		if (next_edge) {
+			Memory const* mem_out = mapping.get_mem_out(next_edge->get_src());
+			Memory const* mem_in = mapping.get_mem_in(next_edge->get_snk());
 
-				Time const t_start = std::max({ time[processor], time[mem_in], time[mem_out] });
-				Time const t_end = t_start + sys.computation_time_ms(next_task, processor) + sys.transaction_time_ms(next_task->get_input_size(), mem_in, processor) + sys.transaction_time_ms(next_task->get_output_size(), processor, mem_out);
-				time[processor] = t_end;
-				time[mem_in] = t_end;
-				time[mem_out] = t_end;
+			Time const t_start = std::max(time[mem_out->get_id()], time[mem_in->get_id()]);
+			Time const t_end = t_start + costs.edge_time(next_edge, mem_out, mem_in);
+			time[mem_out->get_id()] = t_end;
+			time[mem_in->get_id()] = t_end;
+			return { t_start, t_end };
+		}
 
-				if (log_results) log.log(next_task, t_start, t_end);
-			}
+		SubGraph* next_graph = element.get_subgraph();
+		if (!next_graph) {
+			return { 0, 0 }; // Released element
+		}
+		DeviceMask const devices = next_graph->get_devices();
+		Time t_start = 0;
+		for (DeviceMask mask = devices; mask; mask &= mask - 1) {
+			t_start = std::max(t_start, time[std::countr_zero(mask)]);
+		}
 
-			Edge* next_edge = element.get_edge();
-			if (next_edge) {
-				Memory const* mem_out = mapping.get_mem_out(next_edge->get_src());
-				Memory const* mem_in = mapping.get_mem_in(next_edge->get_snk());
+		Time execution_time = 0;
+		for (Task* task : next_graph->get_tasks()) {
+			Processor const* processor = mapping.get_processor(task);
+			execution_time = std::max(execution_time, costs.computation_time(task, processor));
+			execution_time = std::max(execution_time, costs.input_time(task, mapping.get_mem_in(task), processor));
+			execution_time = std::max(execution_time, costs.output_time(task, processor, mapping.get_mem_out(task)));
+		}
 
-				Time const t_start = std::max(time[mem_out], time[mem_in]);
-				Time const t_end = t_start + sys.transaction_time_ms(next_edge->get_src()->get_output_size(), mem_out, mem_in);
-				time[mem_out] = t_end;
-				time[mem_in] = t_end;
+		for (Edge* edge : next_graph->get_edges()) {
+			execution_time = std::max(execution_time, costs.edge_time(edge, mapping.get_mem_out(edge->get_src()), mapping.get_mem_in(edge->get_snk())));
+		}
 
-				if (log_results) log.log(next_edge, t_start, t_end);
-			}
+		Time const t_end = t_start + execution_time;
 
-			SubGraph* next_graph = element.get_subgraph();
-			if (next_graph) {
-				auto const& devices = next_graph->get_devices();
-				Time const t_start = time[*std::max_element(devices.begin(), devices.end(), [&time](Device const* dev1, Device const* dev2) { return time[dev1] < time[dev2]; })];
+		for (DeviceMask mask = devices; mask; mask &= mask - 1) {
+			time[std::countr_zero(mask)] = t_end;
+		}
+		return { t_start, t_end };
+	}
 
-				Time execution_time = 0;
-				for (Task* task : next_graph->get_tasks()) {
-					execution_time = std::max(execution_time, sys.computation_time_ms(task, mapping.get_processor(task)));
-					execution_time = std::max(execution_time, sys.transaction_time_ms(task->get_input_size(), mapping.get_mem_in(task), mapping.get_processor(task)));
-					execution_time = std::max(execution_time, sys.transaction_time_ms(task->get_output_size(), mapping.get_processor(task), mapping.get_mem_out(task)));
-				}
+	// With runs > 1, the best schedule found within runs simulations, see optimize_schedule. The search is randomized
+	// by streams and stops early once it reaches lower_bound.
+	template <class MappingType>
+	Time evaluate_mapping_with_check(MappingType const& mapping, int runs = 1, Time lower_bound = 0, RandomStreams const& streams = RandomStreams()) {
+		Task* dbg_task;
+		if (!is_complete(mapping, &dbg_task)) {
+			std::cerr << "Mapping incomplete. Missing value for task " << dbg_task->get_label() << std::endl;
+			return -1;
+		}
+		if (!is_compatible(mapping, &dbg_task)) {
+			std::cerr << "Mapping invalid. Incompatible processor for task " << dbg_task->get_label() << std::endl;
+			return -1;
+		}
+		Processor const* dbg_processor;
+		if (!satisfies_capacity_constraint(mapping, &dbg_processor)) {
+			std::cerr << "Mapping invalid. Not enough capacity for " << dbg_processor->get_label() << std::endl;
+			return -1;
+		}
 
-				for (Edge* edge : next_graph->get_edges()) {
-					execution_time = std::max(execution_time, sys.transaction_time_ms(edge->get_src()->get_output_size(), mapping.get_mem_out(edge->get_src()), mapping.get_mem_in(edge->get_snk())));
-				}
+		if (runs > 1) {
+			return optimize_schedule(mapping, runs, lower_bound, streams);
+		}
 
-				Time const t_end = t_start + execution_time;
+		return compute_cost(mapping);
+	}
 
-				for (Device const* device : devices) {
-					time[device] = t_end;
-				}
+private:
+	// The log is a template parameter, so the simulation without it has no branch per element
+	template <bool LOG, class MappingType>
+	Time simulate_sorting(MappingType const& mapping, TopologicalSorting const& sorting) const {
+		std::vector<Time>& time = device_times;
+		time.assign(sys.get_platform().get_devices().size(), 0);
 
-				if (log_results) {
-					for (Task* task : next_graph->get_tasks()) {
-						log.log(task, t_start, t_end);
+		for (GraphElement element : sorting.get_sorted_elements()) {
+			auto const [t_start, t_end] = simulate_element(element, mapping, time);
+
+			if constexpr (LOG) {
+				if (element.get_task()) {
+					log.log(element.get_task(), t_start, t_end);
+				}
+				else if (element.get_edge()) {
+					log.log(element.get_edge(), t_start, t_end);
+				}
+				else if (element.get_subgraph()) {
+					size_t const subgraph = log.new_subgraph();
+					for (Task* task : element.get_subgraph()->get_tasks()) {
+						log.log(task, t_start, t_end, subgraph);
 					}
 
-					for (Edge* edge : next_graph->get_edges()) {
+					for (Edge* edge : element.get_subgraph()->get_edges()) {
 						log.log(edge, t_start, t_end);
 					}
 				}
@@ -188,54 +339,287 @@ public:
 		}
 
 		Time result = 0;
-		for (auto& it : time) {
-			result = std::max(result, it.second);
+		for (Time const& t : time) {
+			result = std::max(result, t);
 		}
 		return result;
 	}
 
-	Time evaluate_mapping_with_check(Mapping const& mapping, int runs = 1) {
-		Task* dbg_task;
-		if (!is_complete(mapping, &dbg_task)) {
-			std::cerr << "Mapping incomplete. Missing value for task " << dbg_task->get_label() << std::endl;
-			return -1;
+	template <class MappingType>
+	Time compute_cost_uncached(MappingType const& mapping, SORTING_MODE mode) const {
+		if (mode == SORTING_MODE::EVENT_DRIVEN && !needs_compression(mapping)) {
+			return simulate_events(mapping);
 		}
-		if (!is_compatible(mapping, &dbg_task)) {
-			std::cerr << "Mapping invalid. Incompatible processor for task " << dbg_task->get_label() << std::endl;
-			return -1;
+
+		TopologicalSorting const* sorting = context->get_sorting(mode);
+		std::unique_ptr<TopologicalSorting> owned_sorting; // Mapping dependent orders are created per call
+		if (!sorting) {
+			if (mode == SORTING_MODE::MAPPING_BASED) {
+				owned_sorting = std::make_unique<MappingBasedSorting>(sys, costs, mapping);
+			}
+			else {
+				// RANK_BASED, or EVENT_DRIVEN with streaming, which only compressed sortings model
+				owned_sorting = std::make_unique<RankBasedSorting>(sys, costs, mapping);
+			}
+			sorting = owned_sorting.get();
 		}
-		Processor const* dbg_processor;
-		if (!satisfies_capacity_constraint(mapping, &dbg_processor)) {
-			std::cerr << "Mapping invalid. Not enough capacity for " << dbg_processor->get_label() << std::endl;
-			return -1;
+		return compute_cost_compressed(mapping, sorting, owned_sorting.get());
+	}
+
+	// Compresses streamable subtrees of sorting. owned_sorting is compressed in place, otherwise the shared sorting is
+	// only copied if compression changes it.
+	template <class MappingType>
+	Time compute_cost_compressed(MappingType const& mapping, TopologicalSorting const* sorting, TopologicalSorting* owned_sorting) const {
+		TopologicalSorting* compressed = owned_sorting;
+		for (Processor* proc : sys.get_platform().get_processors()) {
+			if (proc->is_streaming_device()) {
+				for (Task* task : graph.get_tasks()) {
+					if (TopologicalSorting::is_streamable(task, mapping, proc)) {
+						if (!compressed) {
+							compressed_sorting.assign(sorting);
+							compressed = &compressed_sorting;
+						}
+						compressed->compress_streamable_subtrees(mapping, proc);
+						break;
+					}
+				}
+			}
 		}
 
-        if (runs > 1) {
-            Time min_cost = std::numeric_limits<Time>::max();
-            EvaluationLog min_log;
-
-            min_cost = compute_cost(mapping);
-            min_log = log;
-
-            /*{
-                Time cost = compute_cost(mapping, SORTING_MODE::MAPPING_BASED);
-                if (cost < min_cost) {
-                    min_cost = cost;
-                    min_log = log;
-                }
-            }*/
-
-            for (int i = 1; i < runs; ++i) {
-                Time cost = compute_cost(mapping, SORTING_MODE::RANDOM);
-                if (cost < min_cost) {
-                    min_cost = cost;
-                    min_log = log;
-                }
-            }
-            log = min_log;
-            return min_cost;
-        }
+		return compute_cost_with_sorting(mapping, compressed ? *compressed : *sorting);
+	}
 
-		return compute_cost(mapping);
+	// The random sorting is compressed in place and resampled by the next call
+	template <class MappingType, class Engine>
+	Time compute_cost_random(MappingType const& mapping, Engine& rng) const {
+		random_sorting.resample(graph, rng, sorting_workspace);
+		return compute_cost_compressed(mapping, &random_sorting, &random_sorting);
+	}
+
+	template <class MappingType>
+	Time simulate_events(MappingType const& mapping) const {
+		if (!event_simulator) {
+			event_simulator = std::make_unique<EventSimulator>(sys, costs);
+		}
+		if (!log_results) {
+			return event_simulator->simulate(mapping);
+		}
+		return event_simulator->simulate(mapping, [this](GraphElement element, Time t_start, Time t_end) {
+			if (Task* task = element.get_task()) {
+				log.log(task, t_start, t_end);
+			}
+			else {
+				log.log(element.get_edge(), t_start, t_end);
+			}
+		});
+	}
+
+	template <class MappingType>
+	bool needs_compression(MappingType const& mapping) const {
+		for (Processor* proc : sys.get_platform().get_processors()) {
+			if (proc->is_streaming_device()) {
+				for (Task* task : graph.get_tasks()) {
+					if (TopologicalSorting::is_streamable(task, mapping, proc)) {
+						return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	// Simulates up to BATCH_LANES mappings on an uncompressed sorting. Unused lanes repeat the first mapping, so all lane
+	// loops have a fixed trip count and operate on contiguous values.
+	template <class MappingType>
+	void compute_batch(std::span<MappingType const> mappings, std::vector<size_t> const& lanes, TopologicalSorting const& sorting, std::vector<Time>& result) const {
+		size_t constexpr K = BATCH_LANES;
+		size_t const nbr_tasks = graph.nbr_tasks();
+
+		batch.processor.resize(nbr_tasks * K);
+		batch.mem_in.resize(nbr_tasks * K);
+		batch.mem_out.resize(nbr_tasks * K);
+		batch.computation.resize(nbr_tasks * K);
+		batch.input.resize(nbr_tasks * K);
+		batch.output.resize(nbr_tasks * K);
+		batch.transfer.resize(graph.nbr_edges() * K);
+
+		MappingType const* lane_mappings[K];
+		for (size_t l = 0; l < K; ++l) {
+			lane_mappings[l] = &mappings[lanes[l < lanes.size() ? l : 0]];
+		}
+
+		// Kind-local indices of processor, input and output memory, read directly from dense mappings
+		auto const device_indices = [](MappingType const& mapping, Task* task) -> std::array<size_t, 3> {
+			if constexpr (std::is_same_v<MappingType, DenseMapping>) {
+				TaskId const id = task->get_id();
+				return { mapping.get_processor_index(id), mapping.get_mem_in_index(id), mapping.get_mem_out_index(id) };
+			}
+			else {
+				return { mapping.get_processor(task)->get_index(), mapping.get_mem_in(task)->get_index(), mapping.get_mem_out(task)->get_index() };
+			}
+		};
+		std::vector<Processor*> const& processors = sys.get_platform().get_processors();
+		std::vector<Memory*> const& memories = sys.get_platform().get_memories();
+
+		for (Task* task : graph.get_tasks()) {
+			TaskId const id = task->get_id();
+			for (size_t l = 0; l < K; ++l) {
+				auto const [processor, mem_in, mem_out] = device_indices(*lane_mappings[l], task);
+				batch.processor[id * K + l] = processors[processor]->get_id();
+				batch.mem_in[id * K + l] = memories[mem_in]->get_id();
+				batch.mem_out[id * K + l] = memories[mem_out]->get_id();
+				batch.computation[id * K + l] = costs.computation_time(id, processor);
+				batch.input[id * K + l] = costs.input_time(id, mem_in, processor);
+				batch.output[id * K + l] = costs.output_time(id, processor, mem_out);
+			}
+		}
+		for (Edge* edge : graph.get_edges()) {
+			EdgeId const id = edge->get_id();
+			for (size_t l = 0; l < K; ++l) {
+				size_t const mem_out = device_indices(*lane_mappings[l], edge->get_src())[2];
+				size_t const mem_in = device_indices(*lane_mappings[l], edge->get_snk())[1];
+				batch.transfer[id * K + l] = costs.edge_time(id, mem_out, mem_in);
+			}
+		}
+
+		std::vector<Time>& time = batch.device_times;
+		time.assign(sys.get_platform().get_devices().size() * K, 0);
+
+		for (GraphElement const& element : sorting.get_sorted_elements()) {
+			if (Task* task = element.get_task()) {
+				size_t const base = task->get_id() * K;
+				for (size_t l = 0; l < K; ++l) {
+					Time& t_proc = time[batch.processor[base + l] * K + l];
+					Time& t_in = time[batch.mem_in[base + l] * K + l];
+					Time& t_out = time[batch.mem_out[base + l] * K + l];
+					Time const t_end = std::max({ t_proc, t_in, t_out }) + batch.computation[base + l] + batch.input[base + l] + batch.output[base + l];
+					t_proc = t_end;
+					t_in = t_end;
+					t_out = t_end;
+				}
+			}
+			else if (Edge* edge = element.get_edge()) {
+				size_t const base = edge->get_id() * K;
+				size_t const src = graph.get_edge_src(edge->get_id()) * K;
+				size_t const snk = graph.get_edge_snk(edge->get_id()) * K;
+				for (size_t l = 0; l < K; ++l) {
+					Time& t_out = time[batch.mem_out[src + l] * K + l];
+					Time& t_in = time[batch.mem_in[snk + l] * K + l];
+					Time const t_end = std::max(t_out, t_in) + batch.transfer[base + l];
+					t_out = t_end;
+					t_in = t_end;
+				}
+			}
+			else {
+				assert(!element.get_subgraph()); // Shared sortings are never compressed
+			}
+		}
+
+		Time makespan[K] = {};
+		for (size_t device = 0; device < time.size() / K; ++device) {
+			for (size_t l = 0; l < K; ++l) {
+				makespan[l] = std::max(makespan[l], time[device * K + l]);
+			}
+		}
+		for (size_t l = 0; l < lanes.size(); ++l) {
+			result[lanes[l]] = makespan[l];
+		}
+	}
+
+	// Searches the order of the elements for a fixed mapping within runs simulations. Starts from the best of the
+	// TASK_FIRST_BFS, the RANK_BASED and the MAPPING_BASED sorting, then improves the order by local search in rounds of
+	// LOCAL_SEARCH_ROUND candidates, each moving one random element to another position its dependencies allow.
+	// Candidate i draws from its own stream streams.stream(i) and the candidates of a round are evaluated in parallel,
+	// so the result does not depend on the number of threads. Only the log of the best order is rebuilt afterwards.
+	template <class MappingType>
+	Time optimize_schedule(MappingType const& mapping, int runs, Time lower_bound, RandomStreams const& streams) {
+		size_t constexpr LOCAL_SEARCH_ROUND = 8;
+
+		ThreadPool threads(std::min(ThreadPool::default_size(), LOCAL_SEARCH_ROUND));
+		std::vector<std::unique_ptr<MappingEvaluator>> evaluators; // By worker, without logging
+		for (size_t worker = 0; worker < threads.size(); ++worker) {
+			evaluators.push_back(std::make_unique<MappingEvaluator>(context));
+		}
+
+		RankBasedSorting const rank_sorting(sys, costs, mapping);
+		MappingBasedSorting const mapping_sorting(sys, costs, mapping);
+		TopologicalSorting const* start_sortings[] = { context->get_sorting(SORTING_MODE::TASK_FIRST_BFS), &rank_sorting, &mapping_sorting };
+		size_t constexpr NBR_STARTS = std::size(start_sortings);
+		Time start_costs[NBR_STARTS];
+		threads.parallel_for(NBR_STARTS, [&](size_t i, size_t worker) {
+			start_costs[i] = evaluators[worker]->compute_cost(mapping, *start_sortings[i]);
+		});
+		size_t const start = std::min_element(start_costs, start_costs + NBR_STARTS) - start_costs;
+		CachedSorting best_sorting(start_sortings[start]);
+		Time best_cost = start_costs[start];
+
+		bool const with_edges = best_sorting.contains_edges();
+		std::vector<size_t> task_position(graph.nbr_tasks());
+		std::vector<size_t> edge_position(graph.nbr_edges());
+		std::vector<CachedSorting> candidates(LOCAL_SEARCH_ROUND);
+		std::vector<Time> candidate_costs(LOCAL_SEARCH_ROUND);
+		size_t simulations = NBR_STARTS;
+		while (best_cost > lower_bound && simulations + LOCAL_SEARCH_ROUND <= static_cast<size_t>(runs)) {
+			std::vector<GraphElement> const& elements = best_sorting.get_sorted_elements();
+			for (size_t i = 0; i < elements.size(); ++i) {
+				if (Task* task = elements[i].get_task()) {
+					task_position[task->get_id()] = i;
+				}
+				else {
+					edge_position[elements[i].get_edge()->get_id()] = i;
+				}
+			}
+
+			// Range of positions the element at position i can take: after its last dependency, before its first dependent
+			auto const valid_positions = [&](size_t i) -> std::pair<size_t, size_t> {
+				size_t earliest = 0;
+				size_t latest = elements.size() - 1;
+				if (Task* task = elements[i].get_task()) {
+					for (EdgeId edge : graph.get_edges_in(task->get_id())) {
+						earliest = std::max(earliest, (with_edges ? edge_position[edge] : task_position[graph.get_edge_src(edge)]) + 1);
+					}
+					for (EdgeId edge : graph.get_edges_out(task->get_id())) {
+						latest = std::min(latest, (with_edges ? edge_position[edge] : task_position[graph.get_edge_snk(edge)]) - 1);
+					}
+				}
+				else {
+					EdgeId const edge = elements[i].get_edge()->get_id();
+					earliest = task_position[graph.get_edge_src(edge)] + 1;
+					latest = task_position[graph.get_edge_snk(edge)] - 1;
+				}
+				return { earliest, latest };
+			};
+
+			threads.parallel_for(LOCAL_SEARCH_ROUND, [&](size_t c, size_t worker) {
+				Xoshiro256 rng = streams.stream(simulations + c);
+				candidates[c].assign(&best_sorting);
+				for (size_t attempt = 0; attempt < elements.size(); ++attempt) {
+					size_t const from = random_index(rng, elements.size());
+					auto const [earliest, latest] = valid_positions(from);
+					if (earliest < latest) {
+						size_t to = earliest + random_index(rng, latest - earliest);
+						if (to >= from) {
+							++to; // Skips the current position
+						}
+						candidates[c].move_element(from, to);
+						break;
+					}
+				}
+				candidate_costs[c] = evaluators[worker]->compute_cost(mapping, candidates[c]);
+			});
+			simulations += LOCAL_SEARCH_ROUND;
+
+			size_t const best_candidate = std::min_element(candidate_costs.begin(), candidate_costs.end()) - candidate_costs.begin();
+			// Equal costs are accepted to move across plateaus
+			if (candidate_costs[best_candidate] <= best_cost) {
+				best_cost = candidate_costs[best_candidate];
+				best_sorting.assign(&candidates[best_candidate]);
+			}
+		}
+
+		if (!log_results) {
+			return best_cost;
+		}
+		return compute_cost(mapping, best_sorting);
 	}
 };
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "types.h"
+#include "Random.h"
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <bit>
+#include <algorithm>
+
+// Bounded cache of evaluated costs by mapping hash (see Mapping::get_hash), shared by all evaluators of an
+// EvaluationContext. Slots are direct-mapped and a new entry replaces the old one. It works without locks: a slot holds
+// the cost and the key XOR the cost, so a slot torn by concurrent writers fails the check and counts as a miss.
+// Costs of colliding 64 bit hashes are confused, which is as unlikely as for any other hash of the mapping.
+class EvaluationCache {
+public:
+	static size_t constexpr DEFAULT_CAPACITY = size_t(1) << 14;
+
+	struct Statistics {
+		size_t hits = 0;
+		size_t misses = 0;
+
+		size_t lookups() const { return hits + misses; }
+		Statistics operator-(Statistics const& other) const { return { hits - other.hits, misses - other.misses }; }
+	};
+
+private:
+	struct Slot {
+		std::atomic<std::uint64_t> check{ 0 }; // key ^ cost
+		std::atomic<std::uint64_t> cost{ 0 }; // Bits of the Time
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	int shift = 64; // The highest bits of a key select its slot
+	std::atomic<size_t> hits{ 0 };
+	std::atomic<size_t> misses{ 0 };
+
+	static inline std::atomic<size_t> total_hits{ 0 };
+	static inline std::atomic<size_t> total_misses{ 0 };
+
+public:
+	// The capacity is rounded up to a power of two, 0 disables the cache
+	EvaluationCache(size_t capacity = DEFAULT_CAPACITY) {
+		if (capacity > 0) {
+			size_t const size = std::bit_ceil(std::max<size_t>(capacity, 2));
+			slots = std::make_unique<Slot[]>(size);
+			shift = 64 - std::countr_zero(size);
+		}
+	}
+
+	~EvaluationCache() {
+		total_hits += hits;
+		total_misses += misses;
+	}
+
+	EvaluationCache(EvaluationCache const&) = delete;
+	EvaluationCache& operator=(EvaluationCache const&) = delete;
+
+	bool enabled() const { return slots != nullptr; }
+
+	// Key of a mapping hash under an evaluation variant, e.g. a SORTING_MODE. Keys are odd, so empty slots never match.
+	static std::uint64_t key(std::uint64_t mapping_hash, unsigned variant) {
+		return (mapping_hash ^ Xoshiro256::mix(variant + 0x9e3779b97f4a7c15)) | 1;
+	}
+
+	bool lookup(std::uint64_t key, Time& cost) {
+		if (!enabled()) {
+			return false;
+		}
+		Slot const& slot = slots[key >> shift];
+		std::uint64_t const bits = slot.cost.load(std::memory_order_relaxed);
+		if ((slot.check.load(std::memory_order_relaxed) ^ bits) != key) {
+			misses.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		hits.fetch_add(1, std::memory_order_relaxed);
+		cost = std::bit_cast<Time>(bits);
+		return true;
+	}
+
+	void store(std::uint64_t key, Time cost) {
+		if (!enabled()) {
+			return;
+		}
+		std::uint64_t const bits = std::bit_cast<std::uint64_t>(cost);
+		Slot& slot = slots[key >> shift];
+		slot.cost.store(bits, std::memory_order_relaxed);
+		slot.check.store(key ^ bits, std::memory_order_relaxed);
+	}
+
+	Statistics get_statistics() const { return { hits.load(), misses.load() }; }
+
+	// Summed over all caches destroyed so far, e.g. the difference around a mapper gives its savings
+	static Statistics get_total_statistics() { return { total_hits.load(), total_misses.load() }; }
+};
\ No newline at end of file
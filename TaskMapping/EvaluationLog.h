@@ -1,31 +1,78 @@
 #pragma once
 #include "TaskGraph.h"
-#include <unordered_map>
+#include <vector>
+#include <utility>
 
 struct TimeRange {
 	Time start_time_ms;
 	Time end_time_ms;
 };
 
+// Start and end times of the tasks and edges of a simulation in flat arrays by task and edge id. Elements that were
+// never logged have the range [-1, -1]. Later simulations overwrite the times, swap exchanges two logs in O(1), so a
+// snapshot of the best schedule needs no copy. The tasks of a compressed streaming subgraph share its time range and
+// carry the same subgraph number.
 class EvaluationLog {
-	std::unordered_map<Task*, TimeRange> computation_times;
-	std::unordered_map<Edge*, TimeRange> transfer_times;
+	static constexpr TimeRange UNLOGGED = { -1, -1 };
+
+	std::vector<TimeRange> computation_times; // By task id
+	std::vector<TimeRange> transfer_times; // By edge id
+	std::vector<size_t> subgraphs; // By task id, 0 if the task was not streamed
+	size_t nbr_subgraphs = 0;
+
+	static void set(std::vector<TimeRange>& times, size_t id, TimeRange const& range) {
+		if (id >= times.size()) {
+			times.resize(id + 1, UNLOGGED);
+		}
+		times[id] = range;
+	}
+
+	static size_t get(std::vector<size_t> const& ids, size_t id) { return id < ids.size() ? ids[id] : 0; }
+	static TimeRange const& get(std::vector<TimeRange> const& times, size_t id) { return id < times.size() ? times[id] : UNLOGGED; }
 
 public:
+	EvaluationLog() = default;
+	EvaluationLog(size_t nbr_tasks, size_t nbr_edges) : computation_times(nbr_tasks, UNLOGGED), transfer_times(nbr_edges, UNLOGGED), subgraphs(nbr_tasks, 0) {}
+
+	// A new number for the tasks of a streaming subgraph
+	size_t new_subgraph() { return ++nbr_subgraphs; }
 
-	void log(Task* task, Time const& start_time_ms, Time const& end_time_ms) {
-		computation_times[task] = { start_time_ms, end_time_ms };
+	void log_task(TaskId task, Time const& start_time_ms, Time const& end_time_ms, size_t subgraph = 0) {
+		set(computation_times, task, { start_time_ms, end_time_ms });
+		if (task >= subgraphs.size()) {
+			subgraphs.resize(task + 1, 0);
+		}
+		subgraphs[task] = subgraph;
 	}
+	void log(Task* task, Time const& start_time_ms, Time const& end_time_ms, size_t subgraph = 0) { log_task(task->get_id(), start_time_ms, end_time_ms, subgraph); }
+	void log_edge(EdgeId edge, Time const& start_time_ms, Time const& end_time_ms) { set(transfer_times, edge, { start_time_ms, end_time_ms }); }
+	void log(Edge* edge, Time const& start_time_ms, Time const& end_time_ms) { log_edge(edge->get_id(), start_time_ms, end_time_ms); }
 
-	void log(Edge* edge, Time const& start_time_ms, Time const& end_time_ms) {
-		transfer_times[edge] = { start_time_ms, end_time_ms };
+	// Keeps the storage
+	void clear() {
+		computation_times.assign(computation_times.size(), UNLOGGED);
+		transfer_times.assign(transfer_times.size(), UNLOGGED);
+		subgraphs.assign(subgraphs.size(), 0);
 	}
 
-	bool contains(Task* task) const { return computation_times.contains(task); }
-	bool contains(Edge* edge) const { return transfer_times.contains(edge); }
+	void swap(EvaluationLog& other) noexcept {
+		computation_times.swap(other.computation_times);
+		transfer_times.swap(other.transfer_times);
+		subgraphs.swap(other.subgraphs);
+		std::swap(nbr_subgraphs, other.nbr_subgraphs);
+	}
+
+	bool contains(Task* task) const { return get(computation_times, task->get_id()).start_time_ms >= 0; }
+	bool contains(Edge* edge) const { return get(transfer_times, edge->get_id()).start_time_ms >= 0; }
+
+	Time start_time_ms(Task* task) const { return get(computation_times, task->get_id()).start_time_ms; }
+	Time start_time_ms(Edge* edge) const { return get(transfer_times, edge->get_id()).start_time_ms; }
+	Time end_time_ms(Task* task) const { return get(computation_times, task->get_id()).end_time_ms; }
+	Time end_time_ms(Edge* edge) const { return get(transfer_times, edge->get_id()).end_time_ms; }
+	size_t get_subgraph(Task* task) const { return get(subgraphs, task->get_id()); }
+
+	size_t nbr_tasks() const { return computation_times.size(); }
+	size_t nbr_edges() const { return transfer_times.size(); }
+};
 
-	Time start_time_ms(Task* task) const { return computation_times.contains(task) ? computation_times.at(task).start_time_ms : -1; }
-	Time start_time_ms(Edge* edge) const { return transfer_times.contains(edge) ? transfer_times.at(edge).start_time_ms : -1; }
-	Time end_time_ms(Task* task) const { return computation_times.contains(task) ? computation_times.at(task).end_time_ms : -1; }
-	Time end_time_ms(Edge* edge) const { return transfer_times.contains(edge) ? transfer_times.at(edge).end_time_ms : -1; }
-};
\ No newline at end of file
+inline void swap(EvaluationLog& a, EvaluationLog& b) noexcept { a.swap(b); }
\ No newline at end of file
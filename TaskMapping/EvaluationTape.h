@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Evaluation.h"
+
+#include <span>
+#include <bit>
+
+// A sorting compiled against a mapping: one record per element holding the set of devices it occupies and its
+// precomputed duration. Simulating a record is a max over the device ready times plus the duration, without any
+// lookups in the mapping or the cost table. Results are identical to MappingEvaluator::simulate_element.
+// When a few tasks move to other devices without changing the sorting, patch() recompiles only their records and
+// those of their edges. The compiled sorting has to outlive the tape.
+class EvaluationTape {
+public:
+	static size_t constexpr NO_POSITION = std::numeric_limits<size_t>::max();
+
+	struct Record {
+		DeviceMask devices; // Bit Device::get_id()
+		Time duration[3]; // Added to the start time one after another, like the computation, input and output time of a task
+	};
+
+private:
+	FrozenTaskGraph const& graph;
+	CostTable const& costs;
+
+	TopologicalSorting const* sorting = nullptr;
+	std::vector<Record> records; // By position in the sorting
+	std::vector<size_t> task_position; // Position of the element containing the task
+	std::vector<size_t> edge_position; // Position of the element containing the edge, NO_POSITION if not sorted
+	std::vector<std::pair<size_t, Record>> patched; // Original records changed by patch(), restored by revert()
+
+public:
+	EvaluationTape(EvaluationContext const& context) : graph(context.get_graph()), costs(context.get_costs()) {}
+
+	size_t size() const { return records.size(); }
+	Record const& get_record(size_t i) const { return records[i]; }
+	size_t get_task_position(TaskId task) const { return task_position[task]; }
+	size_t get_edge_position(EdgeId edge) const { return edge_position[edge]; }
+
+	template <class MappingType>
+	void compile(TopologicalSorting const& sorting, MappingType const& mapping) {
+		this->sorting = &sorting;
+		std::vector<GraphElement> const& elements = sorting.get_sorted_elements();
+
+		records.resize(elements.size());
+		task_position.assign(graph.nbr_tasks(), NO_POSITION);
+		edge_position.assign(graph.nbr_edges(), NO_POSITION);
+		patched.clear();
+		for (size_t i = 0; i < elements.size(); ++i) {
+			records[i] = compile_element(elements[i], mapping);
+			if (Task* task = elements[i].get_task()) {
+				task_position[task->get_id()] = i;
+			}
+			else if (Edge* edge = elements[i].get_edge()) {
+				edge_position[edge->get_id()] = i;
+			}
+			else if (SubGraph* subgraph = elements[i].get_subgraph()) {
+				for (Task* task : subgraph->get_tasks()) {
+					task_position[task->get_id()] = i;
+				}
+				for (Edge* edge : subgraph->get_edges()) {
+					edge_position[edge->get_id()] = i;
+				}
+			}
+		}
+	}
+
+	// Recompiles the records of the changed tasks and their edges for the new mapping. Only valid if the compiled
+	// sorting is still the sorting of the new mapping, i.e. streaming compression is not affected.
+	template <class MappingType>
+	void patch(MappingType const& mapping, std::span<TaskId const> changed_tasks) {
+		std::vector<GraphElement> const& elements = sorting->get_sorted_elements();
+		auto const recompile = [&](size_t i) {
+			if (i != NO_POSITION) {
+				patched.emplace_back(i, records[i]);
+				records[i] = compile_element(elements[i], mapping);
+			}
+		};
+		for (TaskId task : changed_tasks) {
+			recompile(task_position[task]);
+			for (EdgeId edge : graph.get_edges_in(task)) {
+				recompile(edge_position[edge]);
+			}
+			for (EdgeId edge : graph.get_edges_out(task)) {
+				recompile(edge_position[edge]);
+			}
+		}
+	}
+
+	// Restores the records before the patches since the last compile(), revert() or keep()
+	void revert() {
+		for (auto it = patched.rbegin(); it != patched.rend(); ++it) {
+			records[it->first] = it->second;
+		}
+		patched.clear();
+	}
+
+	// Accepts the patches since the last compile(), revert() or keep()
+	void keep() {
+		patched.clear();
+	}
+
+	// Advances the device ready times (indexed by Device::get_id()) by record i
+	void simulate(size_t i, std::vector<Time>& time) const {
+		Record const& record = records[i];
+		Time t_start = 0;
+		for (DeviceMask mask = record.devices; mask; mask &= mask - 1) {
+			t_start = std::max(t_start, time[std::countr_zero(mask)]);
+		}
+		Time const t_end = t_start + record.duration[0] + record.duration[1] + record.duration[2];
+		for (DeviceMask mask = record.devices; mask; mask &= mask - 1) {
+			time[std::countr_zero(mask)] = t_end;
+		}
+	}
+
+	// Makespan of the whole tape, time is used as scratch
+	Time evaluate(std::vector<Time>& time) const {
+		for (size_t i = 0; i < records.size(); ++i) {
+			simulate(i, time);
+		}
+		Time result = 0;
+		for (Time const& t : time) {
+			result = std::max(result, t);
+		}
+		return result;
+	}
+
+private:
+	static DeviceMask bit(Device const* device) { return DeviceMask(1) << device->get_id(); }
+
+	// Same durations as MappingEvaluator::simulate_element
+	template <class MappingType>
+	Record compile_element(GraphElement const& element, MappingType const& mapping) const {
+		if (Task* task = element.get_task()) {
+			Processor const* processor = mapping.get_processor(task);
+			Memory const* mem_in = mapping.get_mem_in(task);
+			Memory const* mem_out = mapping.get_mem_out(task);
+			return { bit(processor) | bit(mem_in) | bit(mem_out), { costs.computation_time(task, processor), costs.input_time(task, mem_in, processor), costs.output_time(task, processor, mem_out) } };
+		}
+
+		if (Edge* edge = element.get_edge()) {
+			Memory const* mem_out = mapping.get_mem_out(edge->get_src());
+			Memory const* mem_in = mapping.get_mem_in(edge->get_snk());
+			return { bit(mem_out) | bit(mem_in), { costs.edge_time(edge, mem_out, mem_in), 0, 0 } };
+		}
+
+		SubGraph* subgraph = element.get_subgraph();
+		if (!subgraph) {
+			return { 0, { 0, 0, 0 } }; // Released element
+		}
+		Time execution_time = 0;
+		for (Task* task : subgraph->get_tasks()) {
+			Processor const* processor = mapping.get_processor(task);
+			execution_time = std::max(execution_time, costs.computation_time(task, processor));
+			execution_time = std::max(execution_time, costs.input_time(task, mapping.get_mem_in(task), processor));
+			execution_time = std::max(execution_time, costs.output_time(task, processor, mapping.get_mem_out(task)));
+		}
+		for (Edge* edge : subgraph->get_edges()) {
+			execution_time = std::max(execution_time, costs.edge_time(edge, mapping.get_mem_out(edge->get_src()), mapping.get_mem_in(edge->get_snk())));
+		}
+		return { subgraph->get_devices(), { execution_time, 0, 0 } };
+	}
+};
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Evaluation.h"
+#include "Parallel.h"
+
+#include <memory>
+#include <span>
+
+// One MappingEvaluator per worker thread on a shared EvaluationContext
+class EvaluatorPool {
+	std::shared_ptr<EvaluationContext const> context;
+	ThreadPool threads;
+	std::vector<std::unique_ptr<MappingEvaluator>> evaluators; // Indexed by worker
+
+public:
+	EvaluatorPool(System const& sys, size_t nbr_threads = ThreadPool::default_size()) :
+		EvaluatorPool(std::make_shared<EvaluationContext const>(sys), nbr_threads) {}
+
+	EvaluatorPool(std::shared_ptr<EvaluationContext const> context, size_t nbr_threads = ThreadPool::default_size()) :
+		context(std::move(context)), threads(nbr_threads)
+	{
+		for (size_t worker = 0; worker < threads.size(); ++worker) {
+			evaluators.push_back(std::make_unique<MappingEvaluator>(this->context));
+		}
+	}
+
+	size_t size() const { return threads.size(); }
+	EvaluationContext const& get_context() const { return *context; }
+	// Worker 0 is the calling thread, so its evaluator can also be used outside of parallel_for
+	MappingEvaluator const& get_evaluator(size_t worker = 0) const { return *evaluators[worker]; }
+
+	// Calls func(index, worker) for every index in [0, n) in parallel, see ThreadPool::parallel_for
+	template <class Func>
+	void parallel_for(size_t n, Func&& func) {
+		threads.parallel_for(n, std::forward<Func>(func));
+	}
+
+	// Splits the mappings into batches of MappingEvaluator::BATCH_LANES, see MappingEvaluator::compute_costs
+	template <class MappingType>
+	std::vector<Time> compute_costs(std::span<MappingType const> mappings, SORTING_MODE mode = SORTING_MODE::TASK_FIRST_BFS) {
+		size_t constexpr K = MappingEvaluator::BATCH_LANES;
+		std::vector<Time> costs(mappings.size());
+		parallel_for((mappings.size() + K - 1) / K, [&](size_t i, size_t worker) {
+			std::span<MappingType const> const batch = mappings.subspan(i * K, std::min(K, mappings.size() - i * K));
+			std::vector<Time> const batch_costs = get_evaluator(worker).compute_costs(batch, mode);
+			std::copy(batch_costs.begin(), batch_costs.end(), costs.begin() + i * K);
+		});
+		return costs;
+	}
+};
\ No newline at end of file
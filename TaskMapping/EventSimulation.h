@@ -0,0 +1,264 @@
+#pragma once
+
+#include "System.h"
+#include "FrozenTaskGraph.h"
+#include "CostTable.h"
+#include "TopologicalSorting.h"
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <bit>
+
+// Discrete-event simulation of a mapping, independent of any sorting. Ready tasks and edges start as soon as all of
+// their devices are free (work-conserving), the one with the longest remaining path (upward rank) first and ties in the
+// order they became ready. Ready elements wait in one queue per set of devices, so an event only looks at the queues of
+// the devices it frees and a simulation takes O((V + E) log V) for a given platform. Durations are the ones of
+// MappingEvaluator::simulate_element, streaming subgraphs are not modeled. The storage is kept between simulations.
+class EventSimulator {
+	struct NoCallback {
+		void operator()(GraphElement, Time, Time) const {}
+	};
+
+	struct ReadyElement {
+		Time rank;
+		size_t ready_order;
+		size_t element;
+
+		// Higher rank first, then earlier ready
+		bool operator<(ReadyElement const& other) const {
+			if (rank != other.rank) return rank < other.rank;
+			return ready_order > other.ready_order;
+		}
+	};
+
+	struct Queue {
+		DeviceMask devices;
+		std::vector<ReadyElement> ready; // Max-heap
+		bool dirty; // Devices freed or elements added since the last dispatch
+	};
+
+	FrozenTaskGraph const& graph;
+	CostTable const& costs;
+	size_t const nbr_devices;
+	std::vector<TaskId> topological_order;
+
+	// Elements are numbered tasks first, then edges: task id or nbr_tasks() + edge id
+	std::vector<DeviceMask> element_devices; // Bit Device::get_id()
+	std::vector<Time> element_duration;
+	std::vector<Time> element_rank;
+	std::vector<size_t> element_queue;
+	std::vector<size_t> dependencies; // Unfinished in-edges by task
+
+	std::vector<Queue> queues; // The first nbr_queues are in use, the rest keeps its storage
+	size_t nbr_queues = 0;
+	std::unordered_map<DeviceMask, size_t> queue_index;
+	std::vector<std::vector<size_t>> device_queues; // Queues using the device, by Device::get_id()
+	std::vector<size_t> dirty_queues;
+	std::vector<ReadyElement> candidates; // Top element by queue, element holds the queue
+	std::vector<std::pair<Time, size_t>> running; // Min-heap of end time and element
+	size_t ready_count = 0;
+
+public:
+	EventSimulator(System const& sys, CostTable const& costs) :
+		graph(sys.get_task_graph().freeze()),
+		costs(costs),
+		nbr_devices(sys.get_platform().get_devices().size()),
+		device_queues(nbr_devices)
+	{
+		topological_order.assign(graph.get_src().begin(), graph.get_src().end());
+		dependencies.resize(graph.nbr_tasks());
+		for (TaskId task = 0; task < graph.nbr_tasks(); ++task) {
+			dependencies[task] = graph.get_in_degree(task);
+		}
+		for (size_t i = 0; i < topological_order.size(); ++i) {
+			for (EdgeId edge : graph.get_edges_out(topological_order[i])) {
+				if (--dependencies[graph.get_edge_snk(edge)] == 0) {
+					topological_order.push_back(graph.get_edge_snk(edge));
+				}
+			}
+		}
+		element_devices.resize(graph.nbr_tasks() + graph.nbr_edges());
+		element_duration.resize(graph.nbr_tasks() + graph.nbr_edges());
+		element_rank.resize(graph.nbr_tasks() + graph.nbr_edges());
+		element_queue.resize(graph.nbr_tasks() + graph.nbr_edges());
+		running.reserve(nbr_devices);
+	}
+
+	// Makespan of the mapping. on_dispatch(GraphElement, t_start, t_end) is called for every task and edge when it starts.
+	template <class MappingType, class Callback = NoCallback>
+	Time simulate(MappingType const& mapping, Callback&& on_dispatch = {}) {
+		reset_queues();
+		compile(mapping);
+		for (TaskId task = 0; task < graph.nbr_tasks(); ++task) {
+			dependencies[task] = graph.get_in_degree(task);
+		}
+		for (TaskId src_task : graph.get_src()) {
+			make_ready(src_task);
+		}
+
+		DeviceMask busy = 0;
+		Time now = 0;
+		while (true) {
+			// Dispatch at now, only queues with freed devices or new elements can start anything
+			candidates.clear();
+			for (size_t q : dirty_queues) {
+				queues[q].dirty = false;
+				if (!queues[q].ready.empty() && !(queues[q].devices & busy)) {
+					candidates.push_back({ queues[q].ready.front().rank, queues[q].ready.front().ready_order, q });
+				}
+			}
+			dirty_queues.clear();
+			std::sort(candidates.begin(), candidates.end(), [](ReadyElement const& a, ReadyElement const& b) { return b < a; });
+			for (ReadyElement const& candidate : candidates) {
+				Queue& queue = queues[candidate.element];
+				if (queue.devices & busy) {
+					continue; // Taken by a higher ranked element of another queue
+				}
+				std::pop_heap(queue.ready.begin(), queue.ready.end());
+				size_t const element = queue.ready.back().element;
+				queue.ready.pop_back();
+
+				Time const t_end = now + element_duration[element];
+				busy |= queue.devices;
+				running.emplace_back(t_end, element);
+				std::push_heap(running.begin(), running.end(), std::greater<>());
+				on_dispatch(to_graph_element(element), now, t_end);
+			}
+
+			if (running.empty()) {
+				break;
+			}
+
+			// Finish everything ending at the next event time
+			now = running.front().first;
+			while (!running.empty() && running.front().first == now) {
+				std::pop_heap(running.begin(), running.end(), std::greater<>());
+				size_t const element = running.back().second;
+				running.pop_back();
+
+				busy &= ~element_devices[element];
+				for (DeviceMask mask = element_devices[element]; mask; mask &= mask - 1) {
+					for (size_t q : device_queues[std::countr_zero(mask)]) {
+						mark_dirty(q);
+					}
+				}
+				finish(element);
+			}
+		}
+		return now;
+	}
+
+private:
+	static DeviceMask bit(Device const* device) { return DeviceMask(1) << device->get_id(); }
+
+	GraphElement to_graph_element(size_t element) const {
+		if (element < graph.nbr_tasks()) {
+			return graph.get_task(element);
+		}
+		return graph.get_edge(element - graph.nbr_tasks());
+	}
+
+	// Devices, queues, durations and upward ranks of all elements under the mapping
+	template <class MappingType>
+	void compile(MappingType const& mapping) {
+		size_t const nbr_tasks = graph.nbr_tasks();
+		for (Task* task : graph.get_tasks()) {
+			Processor const* processor = mapping.get_processor(task);
+			Memory const* mem_in = mapping.get_mem_in(task);
+			Memory const* mem_out = mapping.get_mem_out(task);
+			element_devices[task->get_id()] = bit(processor) | bit(mem_in) | bit(mem_out);
+			element_duration[task->get_id()] = costs.computation_time(task, processor) + costs.input_time(task, mem_in, processor) + costs.output_time(task, processor, mem_out);
+		}
+		for (Edge* edge : graph.get_edges()) {
+			Memory const* mem_out = mapping.get_mem_out(edge->get_src());
+			Memory const* mem_in = mapping.get_mem_in(edge->get_snk());
+			element_devices[nbr_tasks + edge->get_id()] = bit(mem_out) | bit(mem_in);
+			element_duration[nbr_tasks + edge->get_id()] = costs.edge_time(edge, mem_out, mem_in);
+		}
+		for (size_t element = 0; element < element_devices.size(); ++element) {
+			element_queue[element] = queue_of(element_devices[element]);
+		}
+
+		for (auto it = topological_order.rbegin(); it != topological_order.rend(); ++it) {
+			Time successor_rank = 0;
+			for (EdgeId edge : graph.get_edges_out(*it)) {
+				size_t const element = nbr_tasks + edge;
+				element_rank[element] = element_duration[element] + element_rank[graph.get_edge_snk(edge)];
+				successor_rank = std::max(successor_rank, element_rank[element]);
+			}
+			element_rank[*it] = element_duration[*it] + successor_rank;
+		}
+	}
+
+	void reset_queues() {
+		for (size_t q = 0; q < nbr_queues; ++q) {
+			queues[q].ready.clear();
+			queues[q].dirty = false;
+		}
+		nbr_queues = 0;
+		queue_index.clear();
+		for (std::vector<size_t>& device_queue : device_queues) {
+			device_queue.clear();
+		}
+		dirty_queues.clear();
+		running.clear();
+		ready_count = 0;
+	}
+
+	size_t queue_of(DeviceMask devices) {
+		auto [it, inserted] = queue_index.try_emplace(devices, nbr_queues);
+		if (inserted) {
+			if (nbr_queues == queues.size()) {
+				queues.emplace_back();
+			}
+			queues[nbr_queues].devices = devices;
+			for (DeviceMask mask = devices; mask; mask &= mask - 1) {
+				device_queues[std::countr_zero(mask)].push_back(nbr_queues);
+			}
+			++nbr_queues;
+		}
+		return it->second;
+	}
+
+	void mark_dirty(size_t q) {
+		if (!queues[q].dirty) {
+			queues[q].dirty = true;
+			dirty_queues.push_back(q);
+		}
+	}
+
+	void make_ready(size_t element) {
+		size_t const q = element_queue[element];
+		queues[q].ready.push_back({ element_rank[element], ready_count++, element });
+		std::push_heap(queues[q].ready.begin(), queues[q].ready.end());
+		mark_dirty(q);
+	}
+
+	void finish(size_t element) {
+		if (element < graph.nbr_tasks()) {
+			for (EdgeId edge : graph.get_edges_out(element)) {
+				make_ready(graph.nbr_tasks() + edge);
+			}
+		}
+		else if (--dependencies[graph.get_edge_snk(element - graph.nbr_tasks())] == 0) {
+			make_ready(graph.get_edge_snk(element - graph.nbr_tasks()));
+		}
+	}
+};
+
+// List scheduling under a fixed mapping: the dispatch order of the EventSimulator as a sorting, which can be compressed
+// for streaming devices like any other sorting
+class RankBasedSorting : public TopologicalSorting {
+public:
+	template <class MappingType>
+	RankBasedSorting(System const& sys, CostTable const& costs, MappingType const& mapping, bool insert_edges = true) : TopologicalSorting(insert_edges) {
+		EventSimulator simulator(sys, costs);
+		simulator.simulate(mapping, [this](GraphElement element, Time, Time) {
+			if (element.get_task() || this->insert_edges) {
+				sorted_elements.push_back(element);
+			}
+		});
+	}
+};
\ No newline at end of file
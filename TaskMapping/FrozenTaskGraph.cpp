@@ -0,0 +1,73 @@
+#include "FrozenTaskGraph.h"
+
+#include <algorithm>
+
+FrozenTaskGraph::FrozenTaskGraph(TaskGraph const& task_graph) :
+	tasks(task_graph.get_tasks()),
+	edges(task_graph.get_edges())
+{
+	size_t const nbr_tasks = tasks.size();
+	size_t const nbr_edges = edges.size();
+
+	for (Task* task : task_graph.get_src()) {
+		src_tasks.push_back(task->get_id());
+	}
+	for (Task* task : task_graph.get_snk()) {
+		snk_tasks.push_back(task->get_id());
+	}
+	// The sets of TaskGraph are hashed by address, which differs between executions
+	std::sort(src_tasks.begin(), src_tasks.end());
+	std::sort(snk_tasks.begin(), snk_tasks.end());
+
+	edge_src.resize(nbr_edges);
+	edge_snk.resize(nbr_edges);
+	for (Edge* edge : edges) {
+		edge_src[edge->get_id()] = edge->get_src()->get_id();
+		edge_snk[edge->get_id()] = edge->get_snk()->get_id();
+	}
+
+	input_size = task_graph.get_input_sizes();
+	output_size = task_graph.get_output_sizes();
+
+	out_offsets.reserve(nbr_tasks + 1);
+	in_offsets.reserve(nbr_tasks + 1);
+	succ_offsets.reserve(nbr_tasks + 1);
+	out_edges.reserve(nbr_edges);
+	in_edges.reserve(nbr_edges);
+	successors.reserve(nbr_edges);
+
+	complexity.reserve(nbr_tasks);
+	parallelizability.reserve(nbr_tasks);
+	streamability.reserve(nbr_tasks);
+	area.reserve(nbr_tasks);
+
+	// Marks the last task a successor was added for, to filter parallel edges
+	std::vector<TaskId> last_pred(nbr_tasks, static_cast<TaskId>(-1));
+
+	out_offsets.push_back(0);
+	in_offsets.push_back(0);
+	succ_offsets.push_back(0);
+	for (Task* task : tasks) {
+		TaskId const id = task->get_id();
+		for (Edge* edge : task->get_edges_out()) {
+			out_edges.push_back(edge->get_id());
+
+			TaskId const succ = edge->get_snk()->get_id();
+			if (last_pred[succ] != id) {
+				last_pred[succ] = id;
+				successors.push_back(succ);
+			}
+		}
+		for (Edge* edge : task->get_edges_in()) {
+			in_edges.push_back(edge->get_id());
+		}
+		out_offsets.push_back(out_edges.size());
+		in_offsets.push_back(in_edges.size());
+		succ_offsets.push_back(successors.size());
+
+		complexity.push_back(task->get_complexity());
+		parallelizability.push_back(task->get_parallelizability());
+		streamability.push_back(task->get_streamability());
+		area.push_back(task->get_area_requirement());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "TaskGraph.h"
+
+#include <vector>
+#include <span>
+
+// Immutable index-based view of a TaskGraph. Tasks and edges are addressed by their dense ids,
+// adjacency is stored in CSR form and task attributes are stored as structure of arrays.
+class FrozenTaskGraph {
+public:
+	FrozenTaskGraph(TaskGraph const& task_graph);
+
+	size_t nbr_tasks() const { return tasks.size(); }
+	size_t nbr_edges() const { return edges.size(); }
+
+	std::vector<Task*> const& get_tasks() const { return tasks; }
+	std::vector<Edge*> const& get_edges() const { return edges; }
+	Task* get_task(TaskId task) const { return tasks[task]; }
+	Edge* get_edge(EdgeId edge) const { return edges[edge]; }
+
+	// Sorted by id, unlike TaskGraph::get_src() and TaskGraph::get_snk()
+	std::vector<TaskId> const& get_src() const { return src_tasks; }
+	std::vector<TaskId> const& get_snk() const { return snk_tasks; }
+
+	std::span<EdgeId const> get_edges_out(TaskId task) const { return { out_edges.data() + out_offsets[task], out_offsets[task + 1] - out_offsets[task] }; }
+	std::span<EdgeId const> get_edges_in(TaskId task) const { return { in_edges.data() + in_offsets[task], in_offsets[task + 1] - in_offsets[task] }; }
+	std::span<TaskId const> get_successors(TaskId task) const { return { successors.data() + succ_offsets[task], succ_offsets[task + 1] - succ_offsets[task] }; }
+	size_t get_in_degree(TaskId task) const { return in_offsets[task + 1] - in_offsets[task]; }
+	size_t get_out_degree(TaskId task) const { return out_offsets[task + 1] - out_offsets[task]; }
+
+	TaskId get_edge_src(EdgeId edge) const { return edge_src[edge]; }
+	TaskId get_edge_snk(EdgeId edge) const { return edge_snk[edge]; }
+
+	ScaleFactor const& get_complexity(TaskId task) const { return complexity[task]; }
+	Percent const& get_parallelizability(TaskId task) const { return parallelizability[task]; }
+	ScaleFactor const& get_streamability(TaskId task) const { return streamability[task]; }
+	Area const& get_area_requirement(TaskId task) const { return area[task]; }
+	DataSize const& get_input_size(TaskId task) const { return input_size[task]; }
+	DataSize const& get_output_size(TaskId task) const { return output_size[task]; }
+	bool is_streamable(TaskId task) const { return streamability[task] > 1; }
+
+private:
+	std::vector<Task*> tasks;
+	std::vector<Edge*> edges;
+	std::vector<TaskId> src_tasks;
+	std::vector<TaskId> snk_tasks;
+
+	std::vector<size_t> out_offsets;
+	std::vector<EdgeId> out_edges;
+	std::vector<size_t> in_offsets;
+	std::vector<EdgeId> in_edges;
+	std::vector<size_t> succ_offsets;
+	std::vector<TaskId> successors;
+	std::vector<TaskId> edge_src;
+	std::vector<TaskId> edge_snk;
+
+	std::vector<ScaleFactor> complexity;
+	std::vector<Percent> parallelizability;
+	std::vector<ScaleFactor> streamability;
+	std::vector<Area> area;
+	std::vector<DataSize> input_size;
+	std::vector<DataSize> output_size;
+};
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "TaskMapperWithSchedule.h"
 #include "TopologicalSorting.h"
+#include "CostTable.h"
 
 #include <unordered_map>
 #include <list>
@@ -14,20 +15,22 @@ public:
 		Mapping mapping;
 		task_schedule = std::priority_queue<std::pair<Time, Task*>>();
 
-		std::vector<Task*> const& tasks = sys.get_task_graph().get_tasks();
+		FrozenTaskGraph const& task_graph = sys.get_task_graph().freeze();
+		CostTable const costs(sys);
 		std::vector<Processor*> const& processors = sys.get_platform().get_processors();
 
-		std::unordered_map<Task*, Time> rank;
+		std::vector<Time> rank(task_graph.nbr_tasks(), 0);
 
-		BFSSorting topsort(sys.get_task_graph(), false);
+		BFSSorting topsort(task_graph, false);
 		auto& sorted_elements = topsort.get_sorted_elements();
 		for (auto rit = sorted_elements.rbegin(); rit != sorted_elements.rend(); ++rit) {
 			Task* task = rit->get_task();
+			TaskId const task_id = task->get_id();
 			Time avg_computation = 0;
 			int nbr_compatible_proc = 0;
 			for (Processor* proc : processors) {
-				if (sys.is_compatible(task, proc)) {
-					avg_computation += sys.computation_time_ms(task, proc);
+				if (costs.is_compatible(task, proc)) {
+					avg_computation += costs.computation_time(task, proc);
 					++nbr_compatible_proc;
 				}
 			}
@@ -35,15 +38,16 @@ public:
 			avg_computation /= nbr_compatible_proc;
 
 			Time r = 0;
-			for (Task* succ : task->compute_successors()) {
+			for (EdgeId e : task_graph.get_edges_out(task_id)) { // Parallel edges do not change the maximum
+				TaskId const succ_id = task_graph.get_edge_snk(e);
 				Time avg_communication = 0;
 				int nbr_compatible_comm = 0;
 
 				for (Processor* proc : processors) {
-					if (sys.is_compatible(task, proc)) {
+					if (costs.is_compatible(task, proc)) {
 						for (Processor* succ_proc : processors) {
-							if (sys.is_compatible(succ, succ_proc)) {
-                                Time const trans_time = sys.transaction_time_ms(task->get_output_size(), proc->get_default_memory(), succ_proc->get_default_memory());
+							if (costs.is_compatible(succ_id, succ_proc->get_index())) {
+                                Time const trans_time = costs.edge_time(e, proc->get_default_memory()->get_index(), succ_proc->get_default_memory()->get_index());
                                 if (trans_time < std::numeric_limits<Time>::infinity()) {
                                     avg_communication +=  trans_time;
                                     ++nbr_compatible_comm;
@@ -54,21 +58,21 @@ public:
 				}
 				avg_communication /= nbr_compatible_comm;
 
-				r = std::max(r, rank[succ] + avg_communication);
+				r = std::max(r, rank[succ_id] + avg_communication);
 			}
-			rank[task] = std::nextafter(r, std::numeric_limits<Time>::infinity()); // Guarantees that order is preserved if avg_time == 0
+			rank[task_id] = std::nextafter(r, std::numeric_limits<Time>::infinity()); // Guarantees that order is preserved if avg_time == 0
 
 #ifndef NDEBUG
-            for (Task* succ : task->compute_successors()) {
-                assert(rank[task] > rank[succ]);
+            for (TaskId succ_id : task_graph.get_successors(task_id)) {
+                assert(rank[task_id] > rank[succ_id]);
             }
 #endif
 		}
 
-		std::vector<Task*> prioritized_tasks(tasks.size());
-		std::partial_sort_copy(tasks.begin(), tasks.end(), prioritized_tasks.begin(), prioritized_tasks.end(), [&rank](Task* t, Task* other) {return rank[t] > rank[other];});
+		std::vector<Task*> prioritized_tasks(task_graph.nbr_tasks());
+		std::partial_sort_copy(task_graph.get_tasks().begin(), task_graph.get_tasks().end(), prioritized_tasks.begin(), prioritized_tasks.end(), [&rank](Task* t, Task* other) {return rank[t->get_id()] > rank[other->get_id()];});
 
-		std::unordered_map<Task*, Time> scheduled_finish_time;
+		std::vector<Time> scheduled_finish_time(task_graph.nbr_tasks(), 0);
 		std::unordered_map<Processor*, std::list<std::pair<Time, Time>> > free_slots;
 		std::unordered_map<Processor*, Area> remaining_area;
 		for (Processor* proc : processors) {
@@ -83,11 +87,11 @@ public:
 			std::pair<Time, Time> min_slot(0, std::numeric_limits<Time>::infinity());
 
 			for (Processor* proc : processors) {
-				if (sys.is_compatible(task, proc) && (!proc->has_maximum_capacity() || task->get_area_requirement() <= remaining_area[proc])) {
+				if (costs.is_compatible(task, proc) && (!proc->has_maximum_capacity() || task_graph.get_area_requirement(task->get_id()) <= remaining_area[proc])) {
 					Time min_start_time = 0;
-					for (Edge* e : task->get_edges_in()) {
-                        assert(scheduled_finish_time.contains(e->get_src()));
-						min_start_time = std::max(min_start_time, scheduled_finish_time.at(e->get_src()) + sys.transaction_time_ms(e->get_src()->get_output_size(), mapping.get_mem_out(e->get_src()), proc->get_default_memory()));
+					for (EdgeId e : task_graph.get_edges_in(task->get_id())) {
+						TaskId const src_id = task_graph.get_edge_src(e);
+						min_start_time = std::max(min_start_time, scheduled_finish_time[src_id] + costs.edge_time(e, mapping.get_mem_out(task_graph.get_task(src_id))->get_index(), proc->get_default_memory()->get_index()));
 					}
 
                     if (min_start_time == std::numeric_limits<Time>::infinity()) {
@@ -95,7 +99,7 @@ public:
                     }
 
 					for (auto& slot : free_slots[proc]) {
-						Time finish_time = std::max(min_start_time, slot.first) + sys.computation_time_ms(task, proc);
+						Time finish_time = std::max(min_start_time, slot.first) + costs.computation_time(task, proc);
 						if (finish_time <= slot.second) {
 							if (finish_time < min_slot.second) {
 								min_slot = { std::max(min_start_time, slot.first), finish_time };
@@ -123,10 +127,10 @@ public:
 			}
 
 			if (min_proc->has_maximum_capacity()) {
-				remaining_area[min_proc] -= task->get_area_requirement();
+				remaining_area[min_proc] -= task_graph.get_area_requirement(task->get_id());
 			}
 
-			scheduled_finish_time[task] = min_slot.second;
+			scheduled_finish_time[task->get_id()] = min_slot.second;
 			mapping.map(task, min_proc);
 		}
 
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "Evaluation.h"
+#include "EvaluationTape.h"
+
+#include <memory>
+#include <span>
+
+// Evaluates mappings that differ from a base mapping in a few tasks. The schedule of the base mapping is kept as
+// device ready times at every CHECKPOINT_DISTANCE-th element of the sorting. A changed mapping is only re-simulated from
+// the last checkpoint before the first affected element and the simulation stops as soon as the device times match
+// the base schedule again. The base sorting is kept as an EvaluationTape, which is patched for candidates that keep the
+// sorting. Results are identical to MappingEvaluator::compute_cost with the same sorting mode and share its cache.
+class IncrementalEvaluator {
+	static size_t constexpr CHECKPOINT_DISTANCE = 32;
+	static size_t constexpr NO_POSITION = EvaluationTape::NO_POSITION;
+
+	MappingEvaluator const& eval;
+	SORTING_MODE const mode;
+	EvaluationCache& cache;
+	FrozenTaskGraph const& graph;
+	std::vector<Processor*> const& processors;
+	size_t const nbr_devices;
+
+	TopologicalSorting const* order; // Uncompressed, independent of the mapping
+	CachedSorting base_sorting;
+	CachedSorting candidate_sorting;
+	EvaluationTape tape; // Base sorting compiled against the base mapping, patched with the last candidate if it keeps the sorting
+
+	// Base schedule
+	std::vector<Time> checkpoints; // Device times before element i * CHECKPOINT_DISTANCE, row-major by checkpoint
+	std::vector<DeviceIndex> base_processor; // By task id
+	std::vector<size_t> tasks_per_processor; // By processor index
+	Time base_cost = 0;
+
+	// Last evaluated candidate, adopted by commit()
+	std::vector<TaskId> candidate_tasks;
+	std::vector<Time> candidate_checkpoints; // Checkpoints first_candidate_checkpoint, first_candidate_checkpoint + 1, ...
+	size_t first_candidate_checkpoint = 0;
+	Time candidate_cost = 0;
+	bool candidate_reusable = false;
+
+	std::vector<Time> time; // Scratch
+
+public:
+	IncrementalEvaluator(MappingEvaluator const& eval, SORTING_MODE mode = SORTING_MODE::TASK_FIRST_BFS) :
+		eval(eval),
+		mode(mode),
+		cache(eval.get_context()->get_cache()),
+		graph(eval.get_sys().get_task_graph().freeze()),
+		processors(eval.get_sys().get_platform().get_processors()),
+		nbr_devices(eval.get_sys().get_platform().get_devices().size()),
+		order(eval.get_context()->get_sorting(mode)),
+		tape(*eval.get_context())
+	{
+		assert(order); // Only mapping independent, deterministic sortings can be reused
+	}
+
+	Time get_base_cost() const { return base_cost; }
+
+	// Simulates the full schedule of the new base mapping
+	template <class MappingType>
+	Time set_base(MappingType const& mapping) {
+		base_processor.assign(graph.nbr_tasks(), 0);
+		tasks_per_processor.assign(processors.size(), 0);
+		for (Task* task : graph.get_tasks()) {
+			DeviceIndex const proc = static_cast<DeviceIndex>(mapping.get_processor(task)->get_index());
+			base_processor[task->get_id()] = proc;
+			++tasks_per_processor[proc];
+		}
+
+		create_sorting(mapping, tasks_per_processor, base_sorting);
+		tape.compile(base_sorting, mapping);
+
+		checkpoints.clear();
+		time.assign(nbr_devices, 0);
+		for (size_t i = 0; i < tape.size(); ++i) {
+			if (i % CHECKPOINT_DISTANCE == 0) {
+				checkpoints.insert(checkpoints.end(), time.begin(), time.end());
+			}
+			tape.simulate(i, time);
+		}
+		base_cost = max_time();
+		cache.store(cache_key(mapping), base_cost);
+
+		candidate_reusable = false;
+		return base_cost;
+	}
+
+	// changed_tasks has to contain every task whose mapping differs from the base mapping, e.g. MappingView::get_mapped_tasks().
+	// A cached cost skips the simulation, a commit of such a candidate simulates the full schedule.
+	template <class MappingType>
+	Time compute_cost(MappingType const& mapping, std::span<TaskId const> changed_tasks) {
+		candidate_reusable = false;
+		tape.revert();
+		std::uint64_t const key = cache_key(mapping);
+		if (cache.lookup(key, candidate_cost)) {
+			return candidate_cost;
+		}
+		cache.store(key, simulate_candidate(mapping, changed_tasks));
+		return candidate_cost;
+	}
+
+	// Makes the mapping the new base. Cheap if it is the last mapping passed to compute_cost.
+	template <class MappingType>
+	void commit(MappingType const& mapping) {
+		if (!candidate_reusable) {
+			set_base(mapping);
+			return;
+		}
+
+		for (TaskId task : candidate_tasks) {
+			--tasks_per_processor[base_processor[task]];
+			base_processor[task] = static_cast<DeviceIndex>(mapping.get_processor(graph.get_task(task))->get_index());
+			++tasks_per_processor[base_processor[task]];
+		}
+		std::copy(candidate_checkpoints.begin(), candidate_checkpoints.end(), checkpoints.begin() + (first_candidate_checkpoint + 1) * nbr_devices);
+		tape.keep();
+		base_cost = candidate_cost;
+		candidate_reusable = false;
+	}
+
+private:
+	template <class MappingType>
+	std::uint64_t cache_key(MappingType const& mapping) const {
+		return EvaluationCache::key(mapping.get_hash(), static_cast<unsigned>(mode));
+	}
+
+	// Simulates the candidate from the last checkpoint before its first change, sets candidate_cost and returns it
+	template <class MappingType>
+	Time simulate_candidate(MappingType const& mapping, std::span<TaskId const> changed_tasks) {
+		std::vector<size_t> candidate_tasks_per_processor = tasks_per_processor;
+		for (TaskId task : changed_tasks) {
+			--candidate_tasks_per_processor[base_processor[task]];
+			++candidate_tasks_per_processor[mapping.get_processor(graph.get_task(task))->get_index()];
+		}
+
+		// The candidate can only have a different order if streaming compression is involved
+		std::vector<GraphElement> const& base_elements = base_sorting.get_sorted_elements();
+		std::vector<GraphElement> const* elements = &base_elements;
+		if (uses_streaming_processor(tasks_per_processor) || uses_streaming_processor(candidate_tasks_per_processor)) {
+			create_sorting(mapping, candidate_tasks_per_processor, candidate_sorting);
+			elements = &candidate_sorting.get_sorted_elements();
+		}
+		bool const same_sorting = (elements == &base_elements);
+		if (same_sorting) {
+			tape.patch(mapping, changed_tasks);
+		}
+		size_t const n_base = base_elements.size();
+		size_t const n = elements->size();
+
+		// Differing region [prefix, n - suffix) of the candidate and [prefix, n_base - suffix) of the base
+		size_t prefix = 0;
+		size_t suffix = 0;
+		if (!same_sorting) {
+			while (prefix < std::min(n, n_base) && same_element((*elements)[prefix], base_elements[prefix])) {
+				++prefix;
+			}
+			while (suffix < std::min(n, n_base) - prefix && same_element((*elements)[n - suffix - 1], base_elements[n_base - suffix - 1])) {
+				++suffix;
+			}
+		}
+		else {
+			prefix = n;
+		}
+
+		size_t first = (prefix < n || n != n_base) ? prefix : NO_POSITION;
+		size_t last = (prefix < n - suffix) ? n - suffix - 1 : 0;
+		auto const touch = [&](size_t base_pos) {
+			size_t pos;
+			if (base_pos < prefix) {
+				pos = base_pos;
+			}
+			else if (base_pos >= n_base - suffix) {
+				pos = base_pos - n_base + n;
+			}
+			else {
+				return; // Within the differing region
+			}
+			first = (first == NO_POSITION) ? pos : std::min(first, pos);
+			last = std::max(last, pos);
+		};
+		for (TaskId task : changed_tasks) {
+			touch(tape.get_task_position(task));
+			for (EdgeId edge : graph.get_edges_in(task)) {
+				if (tape.get_edge_position(edge) != NO_POSITION) touch(tape.get_edge_position(edge));
+			}
+			for (EdgeId edge : graph.get_edges_out(task)) {
+				if (tape.get_edge_position(edge) != NO_POSITION) touch(tape.get_edge_position(edge));
+			}
+		}
+
+		candidate_tasks.assign(changed_tasks.begin(), changed_tasks.end());
+		candidate_checkpoints.clear();
+		if (first == NO_POSITION) {
+			candidate_cost = base_cost;
+			candidate_reusable = same_sorting;
+			return candidate_cost;
+		}
+
+		first_candidate_checkpoint = first / CHECKPOINT_DISTANCE;
+		time.assign(checkpoints.begin() + first_candidate_checkpoint * nbr_devices, checkpoints.begin() + (first_candidate_checkpoint + 1) * nbr_devices);
+		candidate_cost = -1;
+		for (size_t i = first_candidate_checkpoint * CHECKPOINT_DISTANCE; i < n; ++i) {
+			size_t const base_i = i + n_base - n;
+			if (i > last && base_i % CHECKPOINT_DISTANCE == 0 && std::equal(time.begin(), time.end(), checkpoints.begin() + (base_i / CHECKPOINT_DISTANCE) * nbr_devices)) {
+				candidate_cost = base_cost; // Remaining schedule is identical to the base
+				break;
+			}
+			if (i % CHECKPOINT_DISTANCE == 0 && i > first_candidate_checkpoint * CHECKPOINT_DISTANCE) {
+				candidate_checkpoints.insert(candidate_checkpoints.end(), time.begin(), time.end());
+			}
+			if (same_sorting) {
+				tape.simulate(i, time);
+			}
+			else {
+				eval.simulate_element((*elements)[i], mapping, time);
+			}
+		}
+		if (candidate_cost < 0) {
+			candidate_cost = max_time();
+		}
+
+		candidate_reusable = same_sorting;
+		return candidate_cost;
+	}
+
+	Time max_time() const {
+		Time result = 0;
+		for (Time const& t : time) {
+			result = std::max(result, t);
+		}
+		return result;
+	}
+
+	bool uses_streaming_processor(std::vector<size_t> const& nbr_tasks) const {
+		for (Processor const* proc : processors) {
+			if (proc->is_streaming_device() && nbr_tasks[proc->get_index()] > 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Same compression as MappingEvaluator::compute_cost, reuses the storage of sorting
+	template <class MappingType>
+	void create_sorting(MappingType const& mapping, std::vector<size_t> const& nbr_tasks, CachedSorting& sorting) const {
+		sorting.assign(order);
+		for (Processor const* proc : processors) {
+			if (proc->is_streaming_device() && nbr_tasks[proc->get_index()] > 0) {
+				sorting.compress_streamable_subtrees(mapping, proc);
+			}
+		}
+	}
+
+	static bool same_element(GraphElement const& elem1, GraphElement const& elem2) {
+		if (elem1.get_subgraph() && elem2.get_subgraph()) {
+			return std::ranges::equal(elem1.get_subgraph()->get_tasks(), elem2.get_subgraph()->get_tasks()) && std::ranges::equal(elem1.get_subgraph()->get_edges(), elem2.get_subgraph()->get_edges());
+		}
+		return elem1.get_ptr() == elem2.get_ptr();
+	}
+};
\ No newline at end of file
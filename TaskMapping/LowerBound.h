@@ -0,0 +1,196 @@
+#pragma once
+
+#include "Evaluation.h"
+
+#include <span>
+#include <bit>
+
+// Lower bounds on the cost computed by MappingEvaluator::compute_cost, used to skip candidates that cannot beat an incumbent.
+// Every element of a sorting occupies its devices exclusively, so the summed busy time of any device (memories included)
+// is a bound, and transfers are part of the busy time of both memories. Tasks and edges that can be compressed into
+// streaming subgraphs only count with their maximum, so they are left out. Paths are only counted through elements that
+// stay in their place in the sorting, which passes each dependency on through a shared memory. The bounds are relaxed by BOUND_TOLERANCE to
+// absorb differences in rounding and in the incremental updates.
+class LowerBoundEvaluator {
+	static constexpr Time BOUND_TOLERANCE = 1e-9;
+
+	struct Contribution {
+		DeviceMask devices = 0; // Bit Device::get_id()
+		Time duration = 0; // Busy time on each of the devices
+	};
+
+	// Summed busy time by Device::get_id(). Infinite durations are counted separately, so they can be removed again.
+	struct Busy {
+		std::vector<Time> time;
+		std::vector<int> nbr_infinite;
+
+		Busy(size_t nbr_devices = 0) : time(nbr_devices, 0), nbr_infinite(nbr_devices, 0) {}
+
+		void add(Contribution const& contribution, int sign) {
+			for (DeviceMask mask = contribution.devices; mask; mask &= mask - 1) {
+				if (contribution.duration == std::numeric_limits<Time>::infinity()) {
+					nbr_infinite[std::countr_zero(mask)] += sign;
+				}
+				else {
+					time[std::countr_zero(mask)] += sign * contribution.duration;
+				}
+			}
+		}
+
+		Time max() const {
+			Time result = 0;
+			for (size_t device = 0; device < time.size(); ++device) {
+				result = std::max(result, nbr_infinite[device] > 0 ? std::numeric_limits<Time>::infinity() : time[device]);
+			}
+			return result;
+		}
+	};
+
+	System const& sys;
+	FrozenTaskGraph const& graph;
+	CostTable const& costs;
+	TopologicalSorting const& order; // Topological order of the tasks for the critical path
+	size_t const nbr_devices;
+
+	// Base mapping
+	std::vector<Contribution> task_contribution; // By task id
+	std::vector<Contribution> edge_contribution; // By edge id
+	Busy busy;
+
+	// Last candidate, adopted by commit()
+	std::vector<TaskId> candidate_tasks;
+	std::vector<EdgeId> candidate_edges;
+	Busy candidate_busy;
+	bool candidate_valid = false;
+
+public:
+	LowerBoundEvaluator(EvaluationContext const& context) :
+		sys(context.get_sys()),
+		graph(context.get_graph()),
+		costs(context.get_costs()),
+		order(*context.get_sorting(SORTING_MODE::TASK_FIRST_BFS)),
+		nbr_devices(sys.get_platform().get_devices().size())
+	{}
+
+	// Maximum of the critical path, where each task and edge takes its duration under the mapping, and the busiest device.
+	// O(V + E), independent of any base mapping.
+	template <class MappingType>
+	Time compute_bound(MappingType const& mapping) const {
+		Busy device_busy(nbr_devices);
+		std::vector<Time> finish(graph.nbr_tasks(), 0); // Longest path ending with the task
+		Time critical_path = 0;
+		for (GraphElement const& element : order.get_sorted_elements()) {
+			Task* task = element.get_task();
+			if (!task) {
+				continue;
+			}
+			Contribution const contribution = task_contribution_of(task, mapping);
+			device_busy.add(contribution, 1);
+
+			Time start = 0;
+			for (EdgeId edge : graph.get_edges_in(task->get_id())) {
+				Contribution const edge_contribution = edge_contribution_of(graph.get_edge(edge), mapping);
+				device_busy.add(edge_contribution, 1);
+				start = std::max(start, finish[graph.get_edge_src(edge)] + edge_contribution.duration);
+			}
+			if (contribution.devices == 0) {
+				continue; // Streamed tasks may overlap with their neighbors, paths start again after them
+			}
+			finish[task->get_id()] = start + contribution.duration;
+			critical_path = std::max(critical_path, finish[task->get_id()]);
+		}
+		return relax(std::max(critical_path, device_busy.max()));
+	}
+
+	// Makes the mapping the base of the incremental bounds
+	template <class MappingType>
+	void set_base(MappingType const& mapping) {
+		task_contribution.resize(graph.nbr_tasks());
+		edge_contribution.resize(graph.nbr_edges());
+		busy = Busy(nbr_devices);
+		for (Task* task : graph.get_tasks()) {
+			task_contribution[task->get_id()] = task_contribution_of(task, mapping);
+			busy.add(task_contribution[task->get_id()], 1);
+		}
+		for (Edge* edge : graph.get_edges()) {
+			edge_contribution[edge->get_id()] = edge_contribution_of(edge, mapping);
+			busy.add(edge_contribution[edge->get_id()], 1);
+		}
+		candidate_valid = false;
+	}
+
+	// Busiest device of a mapping that differs from the base mapping in changed_tasks, in O(changed tasks and their edges).
+	// Weaker than the full bound, the critical path is not updated incrementally.
+	template <class MappingType>
+	Time compute_bound(MappingType const& mapping, std::span<TaskId const> changed_tasks) {
+		candidate_busy = busy;
+		candidate_tasks.assign(changed_tasks.begin(), changed_tasks.end());
+		candidate_edges.clear();
+		for (TaskId task : changed_tasks) {
+			candidate_busy.add(task_contribution[task], -1);
+			candidate_busy.add(task_contribution_of(graph.get_task(task), mapping), 1);
+			auto const edges_in = graph.get_edges_in(task);
+			auto const edges_out = graph.get_edges_out(task);
+			candidate_edges.insert(candidate_edges.end(), edges_in.begin(), edges_in.end());
+			candidate_edges.insert(candidate_edges.end(), edges_out.begin(), edges_out.end());
+		}
+		std::sort(candidate_edges.begin(), candidate_edges.end());
+		candidate_edges.erase(std::unique(candidate_edges.begin(), candidate_edges.end()), candidate_edges.end());
+		for (EdgeId edge : candidate_edges) {
+			candidate_busy.add(edge_contribution[edge], -1);
+			candidate_busy.add(edge_contribution_of(graph.get_edge(edge), mapping), 1);
+		}
+		candidate_valid = true;
+		return relax(candidate_busy.max());
+	}
+
+	// Makes the mapping the new base. Cheap if it is the last mapping passed to the incremental compute_bound.
+	template <class MappingType>
+	void commit(MappingType const& mapping) {
+		if (!candidate_valid) {
+			set_base(mapping);
+			return;
+		}
+		for (TaskId task : candidate_tasks) {
+			task_contribution[task] = task_contribution_of(graph.get_task(task), mapping);
+		}
+		for (EdgeId edge : candidate_edges) {
+			edge_contribution[edge] = edge_contribution_of(graph.get_edge(edge), mapping);
+		}
+		std::swap(busy, candidate_busy);
+		candidate_valid = false;
+	}
+
+private:
+	static Time relax(Time bound) { return bound * (1 - BOUND_TOLERANCE); }
+
+	template <class MappingType>
+	bool is_streamable(Task* task, MappingType const& mapping) const {
+		Processor const* processor = mapping.get_processor(task);
+		return processor->is_streaming_device() && TopologicalSorting::is_streamable(task, mapping, processor);
+	}
+
+	// Empty for streamable tasks
+	template <class MappingType>
+	Contribution task_contribution_of(Task* task, MappingType const& mapping) const {
+		if (is_streamable(task, mapping)) {
+			return {};
+		}
+		Processor const* processor = mapping.get_processor(task);
+		Memory const* mem_in = mapping.get_mem_in(task);
+		Memory const* mem_out = mapping.get_mem_out(task);
+		DeviceMask const devices = (DeviceMask(1) << processor->get_id()) | (DeviceMask(1) << mem_in->get_id()) | (DeviceMask(1) << mem_out->get_id());
+		return { devices, costs.computation_time(task, processor) + costs.input_time(task, mem_in, processor) + costs.output_time(task, processor, mem_out) };
+	}
+
+	// Empty for edges that may become part of a streaming subgraph
+	template <class MappingType>
+	Contribution edge_contribution_of(Edge* edge, MappingType const& mapping) const {
+		if (mapping.get_processor(edge->get_src()) == mapping.get_processor(edge->get_snk()) && is_streamable(edge->get_src(), mapping) && is_streamable(edge->get_snk(), mapping)) {
+			return {};
+		}
+		Memory const* mem_out = mapping.get_mem_out(edge->get_src());
+		Memory const* mem_in = mapping.get_mem_in(edge->get_snk());
+		return { (DeviceMask(1) << mem_out->get_id()) | (DeviceMask(1) << mem_in->get_id()), costs.edge_time(edge, mem_out, mem_in) };
+	}
+};
\ No newline at end of file
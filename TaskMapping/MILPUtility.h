@@ -3,6 +3,7 @@
 #include "System.h"
 #include "Mapping.h"
 #include <gurobi_c++.h>
+#include <unordered_map>
 
 typedef std::unordered_map<Task*, std::unordered_map<Device*, GRBVar> > TaskDeviceMap;
 
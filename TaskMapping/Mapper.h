@@ -2,8 +2,10 @@
 
 #include "System.h"
 #include "Mapping.h"
+#include "DenseMapping.h"
 
 class Mapper {
 public:
 	virtual Mapping get_task_mapping(System const&) const = 0;
+	virtual DenseMapping get_dense_task_mapping(System const& sys) const { return DenseMapping(get_task_mapping(sys), sys); }
 };
\ No newline at end of file
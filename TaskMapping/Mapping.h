@@ -1,34 +1,97 @@
 #pragma once
 
 #include "System.h"
-#include <unordered_map>
+#include "Random.h"
+#include <vector>
+#include <cstdint>
+
+// Zobrist-style key of the assignment of a task to devices by Device::get_index(), 0xff for a missing device. The hash
+// of a mapping is the XOR of the keys of its tasks, so remapping a task updates it in O(1). Keys are computed instead of
+// drawn into a table, so Mapping, MappingView and DenseMapping hash alike without knowing the graph size.
+inline std::uint64_t assignment_key(TaskId task, std::uint64_t processor, std::uint64_t mem_in, std::uint64_t mem_out) {
+	return Xoshiro256::mix(((std::uint64_t(task) << 24) | (processor << 16) | (mem_in << 8) | mem_out) + 0x9e3779b97f4a7c15);
+}
 
 class Mapping {
+	friend class MappingView;
 protected:
 	struct DeviceTriplet {
-		Processor const* processor;
-		Memory const* memory_in;
-		Memory const* memory_out;
+		Processor const* processor = nullptr;
+		Memory const* memory_in = nullptr;
+		Memory const* memory_out = nullptr;
+		bool mapped = false;
+		Area area = 0; // Area requirement of the task, counted on the processor
 	};
 
-	std::unordered_map<Task*, DeviceTriplet> mapping;
+	std::vector<DeviceTriplet> mapping; // Indexed by task id
+	std::vector<TaskId> mapped_tasks; // In order of first assignment
+	std::uint64_t hash = 0; // XOR of the assignment keys, for a MappingView XOR the keys its tasks have in the base
+	std::vector<Area> used_area; // By Device::get_index() of the processor, for a MappingView the change to the base
+
+	DeviceTriplet const* find(Task* task) const {
+		return (task->get_id() < mapping.size() && mapping[task->get_id()].mapped) ? &mapping[task->get_id()] : nullptr;
+	}
+
+	static std::uint64_t key_of(TaskId task, DeviceTriplet const& triplet) {
+		auto const index = [](Device const* device) -> std::uint64_t { return device ? device->get_index() : 0xff; };
+		return assignment_key(task, index(triplet.processor), index(triplet.memory_in), index(triplet.memory_out));
+	}
+
+	// Assignment of the task as seen through this mapping, nullptr if it is not mapped
+	virtual DeviceTriplet const* current(TaskId task) const {
+		return (task < mapping.size() && mapping[task].mapped) ? &mapping[task] : nullptr;
+	}
+
+	void add_area(Processor const* processor, Area area) {
+		if (!processor) {
+			return;
+		}
+		if (processor->get_index() >= used_area.size()) {
+			used_area.resize(processor->get_index() + 1, 0);
+		}
+		used_area[processor->get_index()] += area;
+	}
+
+	void assign(TaskId task, DeviceTriplet const& triplet) {
+		if (DeviceTriplet const* previous = current(task)) {
+			hash ^= key_of(task, *previous);
+			add_area(previous->processor, -previous->area);
+		}
+		hash ^= key_of(task, triplet);
+		add_area(triplet.processor, triplet.area);
+		if (task >= mapping.size()) {
+			mapping.resize(task + 1);
+		}
+		if (!mapping[task].mapped) {
+			mapped_tasks.push_back(task);
+		}
+		mapping[task] = triplet;
+		mapping[task].mapped = true;
+	}
 
 public:
 
 	void map(Task* task, Processor const* processor, Memory const* mem_in, Memory const* mem_out) {
-		mapping[task] = { processor, mem_in, mem_out };
+		assign(task->get_id(), { processor, mem_in, mem_out, true, task->get_area_requirement() });
 	}
 
 	void map(Task* task, Processor const* processor) {
 		map(task, processor, processor->get_default_memory(), processor->get_default_memory());
 	}
 
-    bool empty() const { return mapping.empty(); }
+    bool empty() const { return mapped_tasks.empty(); }
+	// For a MappingView only the tasks mapped by the view itself
+	std::vector<TaskId> const& get_mapped_tasks() const { return mapped_tasks; }
+
+	// Hash of the assignments, equal for equal mappings of any type (see assignment_key)
+	virtual std::uint64_t get_hash() const { return hash; }
+	// Summed area requirement of the tasks mapped to the processor, kept up to date by map
+	virtual Area get_used_area(Processor const* processor) const { return processor->get_index() < used_area.size() ? used_area[processor->get_index()] : 0; }
 
-	virtual bool contains(Task* task) const { return mapping.contains(task); }
-	virtual Processor const* get_processor(Task* task) const { return mapping.contains(task) ? mapping.at(task).processor : nullptr; }
-	virtual Memory const* get_mem_in(Task* task) const { return mapping.contains(task) ? mapping.at(task).memory_in : nullptr; }
-	virtual Memory const* get_mem_out(Task* task) const { return mapping.contains(task) ? mapping.at(task).memory_out : nullptr; }
+	virtual bool contains(Task* task) const { return find(task); }
+	virtual Processor const* get_processor(Task* task) const { DeviceTriplet const* t = find(task); return t ? t->processor : nullptr; }
+	virtual Memory const* get_mem_in(Task* task) const { DeviceTriplet const* t = find(task); return t ? t->memory_in : nullptr; }
+	virtual Memory const* get_mem_out(Task* task) const { DeviceTriplet const* t = find(task); return t ? t->memory_out : nullptr; }
 };
 
 class MappingView : public Mapping {
@@ -37,19 +100,33 @@ public:
 	MappingView(): base_mapping(nullptr) {} // Only for copying purpose
 	MappingView(Mapping const* base_mapping) : base_mapping(base_mapping) {}
 
-	bool contains(Task* task) const { return mapping.contains(task) || base_mapping->contains(task); }
-	Processor const* get_processor(Task* task) const { return mapping.contains(task) ? mapping.at(task).processor : base_mapping->get_processor(task); }
-	Memory const* get_mem_in(Task* task) const { return mapping.contains(task) ? mapping.at(task).memory_in : base_mapping->get_mem_in(task); }
-	Memory const* get_mem_out(Task* task) const { return mapping.contains(task) ? mapping.at(task).memory_out : base_mapping->get_mem_out(task); }
+	// The own hash holds the changes relative to the base, so the base must not remap tasks of the view
+	std::uint64_t get_hash() const { return base_mapping->get_hash() ^ hash; }
+	Area get_used_area(Processor const* processor) const { return base_mapping->get_used_area(processor) + Mapping::get_used_area(processor); }
+
+	bool contains(Task* task) const { return find(task) || base_mapping->contains(task); }
+	Processor const* get_processor(Task* task) const { DeviceTriplet const* t = find(task); return t ? t->processor : base_mapping->get_processor(task); }
+	Memory const* get_mem_in(Task* task) const { DeviceTriplet const* t = find(task); return t ? t->memory_in : base_mapping->get_mem_in(task); }
+	Memory const* get_mem_out(Task* task) const { DeviceTriplet const* t = find(task); return t ? t->memory_out : base_mapping->get_mem_out(task); }
 
 	void apply(Mapping& other) {
-		for (auto& elem : mapping) {
-			other.map(elem.first, elem.second.processor, elem.second.memory_in, elem.second.memory_out);
+		for (TaskId task : mapped_tasks) {
+			other.assign(task, mapping[task]);
 		}
 	}
 
 	void reset(Mapping const* new_base_mapping) {
 		base_mapping = new_base_mapping;
-		mapping.clear();
+		for (TaskId task : mapped_tasks) {
+			mapping[task].mapped = false;
+		}
+		mapped_tasks.clear();
+		hash = 0;
+		used_area.clear();
+	}
+
+protected:
+	DeviceTriplet const* current(TaskId task) const {
+		return (task < mapping.size() && mapping[task].mapped) ? &mapping[task] : base_mapping->current(task);
 	}
 };
\ No newline at end of file
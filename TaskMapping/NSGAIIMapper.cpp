@@ -17,20 +17,29 @@ void NSGAIIMapper<CostPolicy>::init(System const& sys) const {
 
 template <class CostPolicy>
 Mapping NSGAIIMapper<CostPolicy>::get_task_mapping(System const& sys) const {
+	return get_dense_task_mapping(sys).to_mapping(sys.get_task_graph().freeze());
+}
+
+template <class CostPolicy>
+DenseMapping NSGAIIMapper<CostPolicy>::get_dense_task_mapping(System const& sys) const {
 	size_t const constexpr POPULATION_SIZE = 100;
 	init(sys);
 
 	GreedyMapper greedy({ "CPU", "Main_RAM" });
-	Mapping greedy_mapping = greedy.get_task_mapping(sys);
+	DenseMapping greedy_mapping = greedy.get_dense_task_mapping(sys);
 
-	MappingEvaluator eval(sys);
-	std::vector<std::pair<Mapping, Time>> population;
+	// Random decisions are made sequentially from one stream, only the evaluation runs in parallel
+	EvaluatorPool pool(sys);
+	MappingEvaluator const& eval = pool.get_evaluator();
+	Xoshiro256 rng = streams.stream();
 
 	// Guarantee to be at least as good as the base mapping
-	population.push_back(std::make_pair(greedy_mapping, CostPolicy::compute_cost(greedy_mapping, eval)));
+	std::vector<DenseMapping> initial_mappings;
+	initial_mappings.push_back(greedy_mapping);
 	for (size_t i = 1; i < POPULATION_SIZE; ++i) {
-		population.push_back(create_valid_random_mapping(eval));
+		initial_mappings.push_back(create_valid_random_mapping(eval, rng));
 	}
+	std::vector<std::pair<DenseMapping, Time>> population = evaluate(std::move(initial_mappings), pool);
 
 #ifndef NO_NSGA_LOG
 	size_t last_change = 0;
@@ -39,11 +48,11 @@ Mapping NSGAIIMapper<CostPolicy>::get_task_mapping(System const& sys) const {
 
 	BFSSorting sorting(sys.get_task_graph(), false);
 	for (size_t i = 0; i < GENERATIONS; ++i) {
-		std::vector<MappingView> parent_selection = select(population, POPULATION_SIZE * 2);
-		mutate(parent_selection, sys);
-		std::vector<std::pair<Mapping, Time>> new_mappings = crossover(parent_selection, sorting.get_sorted_elements(), eval);
-		population.insert(population.end(), new_mappings.begin(), new_mappings.end());
-		std::sort(population.begin(), population.end(), [](std::pair<Mapping, Time> const& p1, std::pair<Mapping, Time> const& p2) { return p1.second < p2.second; });
+		std::vector<DenseMapping> parent_selection = select(population, POPULATION_SIZE * 2, rng);
+		mutate(parent_selection, sys, rng);
+		std::vector<std::pair<DenseMapping, Time>> new_mappings = evaluate(crossover(parent_selection, sorting.get_sorted_elements(), eval, rng), pool);
+		population.insert(population.end(), std::make_move_iterator(new_mappings.begin()), std::make_move_iterator(new_mappings.end()));
+		std::sort(population.begin(), population.end(), [](std::pair<DenseMapping, Time> const& p1, std::pair<DenseMapping, Time> const& p2) { return p1.second < p2.second; });
 		population.resize(POPULATION_SIZE);
 
 #ifndef NO_NSGA_LOG
@@ -63,22 +72,22 @@ Mapping NSGAIIMapper<CostPolicy>::get_task_mapping(System const& sys) const {
 }
 
 template <class CostPolicy>
-std::vector<std::pair<Mapping, Time>> NSGAIIMapper<CostPolicy>::crossover(std::vector<MappingView> const& parent_selection, std::vector<GraphElement> const& sorted_tasks, MappingEvaluator const& eval) const {
-	std::vector<std::pair<Mapping, Time>> new_mappings;
+std::vector<DenseMapping> NSGAIIMapper<CostPolicy>::crossover(std::vector<DenseMapping> const& parent_selection, std::vector<GraphElement> const& sorted_tasks, MappingEvaluator const& eval, Xoshiro256& rng) const {
+	std::vector<DenseMapping> new_mappings;
 	
 	for (size_t j = 1; j < parent_selection.size(); j = j + 2) {
-		MappingView const& firstParent = parent_selection[j-1];
-		MappingView const& secondParent = parent_selection[j];
+		DenseMapping const& firstParent = parent_selection[j-1];
+		DenseMapping const& secondParent = parent_selection[j];
 		size_t crossover_point;
 		// 0.1 probability to not have a crossover
-		if (rand() % 10 == 0) {
-			crossover_point = (rand() % 2) * sorted_tasks.size();
+		if (random_index(rng, 10) == 0) {
+			crossover_point = random_index(rng, 2) * sorted_tasks.size();
 		}
 		else {
-			crossover_point = rand() % sorted_tasks.size();
+			crossover_point = random_index(rng, sorted_tasks.size());
 		}
 
-		Mapping new_mapping;
+		DenseMapping new_mapping(eval.get_sys());
 		for (size_t i = 0; i < sorted_tasks.size(); ++i) {
 			Task* task = sorted_tasks[i].get_task();
 			if (i < crossover_point) {
@@ -89,24 +98,25 @@ std::vector<std::pair<Mapping, Time>> NSGAIIMapper<CostPolicy>::crossover(std::v
 			}
 		}
 
-		new_mappings.push_back(evaluate_and_repair(std::move(new_mapping), eval));
+		new_mappings.push_back(repair(std::move(new_mapping), eval, rng));
 	}
 
 	return new_mappings;
 }
 
 template <class CostPolicy>
-std::vector<MappingView> NSGAIIMapper<CostPolicy>::select(std::vector<std::pair<Mapping, Time>> const& population, size_t parent_population_size) const {
+std::vector<DenseMapping> NSGAIIMapper<CostPolicy>::select(std::vector<std::pair<DenseMapping, Time>> const& population, size_t parent_population_size, Xoshiro256& rng) const {
 
-	std::vector<MappingView> parent_selection;
+	std::vector<DenseMapping> parent_selection;
+	parent_selection.reserve(parent_population_size);
 	for (size_t i = 0; i < parent_population_size; ++i) {
-		size_t first_idx = rand() % population.size();
-		size_t second_idx = rand() % population.size();
+		size_t first_idx = random_index(rng, population.size());
+		size_t second_idx = random_index(rng, population.size());
 
 		if (population[first_idx].second < population[second_idx].second) {
-			parent_selection.push_back(&population[first_idx].first);
+			parent_selection.push_back(population[first_idx].first);
 		} else {
-			parent_selection.push_back(&population[second_idx].first);
+			parent_selection.push_back(population[second_idx].first);
 		}
 	}
 
@@ -114,61 +124,74 @@ std::vector<MappingView> NSGAIIMapper<CostPolicy>::select(std::vector<std::pair<
 }
 
 template <class CostPolicy>
-void NSGAIIMapper<CostPolicy>::mutate(std::vector<MappingView>& parent_selection, System const& sys) const {
-	std::vector<Task*> tasks = sys.get_task_graph().get_tasks();
-	std::vector<Processor*> processors = sys.get_platform().get_processors();
-	for (MappingView& parent : parent_selection) {
+void NSGAIIMapper<CostPolicy>::mutate(std::vector<DenseMapping>& parent_selection, System const& sys, Xoshiro256& rng) const {
+	std::vector<Task*> const& tasks = sys.get_task_graph().get_tasks();
+	std::vector<Processor*> const& processors = sys.get_platform().get_processors();
+	for (DenseMapping& parent : parent_selection) {
 		for (Task* task : tasks) {
 			// Mutation probability of 1/n
-			if (rand() % tasks.size() == 0) {
-				parent.map(task, processors[rand() % processors.size()]);
+			if (random_index(rng, tasks.size()) == 0) {
+				parent.map(task, processors[random_index(rng, processors.size())]);
 			}
 		}
 	}
 }
 
 template <class CostPolicy>
-std::pair<Mapping, Time> NSGAIIMapper<CostPolicy>::evaluate_and_repair(Mapping&& mapping, MappingEvaluator const& eval) const {
+DenseMapping NSGAIIMapper<CostPolicy>::repair(DenseMapping&& mapping, MappingEvaluator const& eval, Xoshiro256& rng) const {
 	std::vector<Task*> const& tasks = eval.get_sys().get_task_graph().get_tasks();
 	for (Task* task : tasks) {
-		if (!eval.get_sys().is_compatible(task, mapping.get_processor(task))) {
+		if (!eval.get_costs().is_compatible(task, mapping.get_processor(task))) {
 			mapping.map(task, default_proc);
 		}
 	}
 
-	Processor const* conflicting_proc;
-	while (!eval.satisfies_capacity_constraint(mapping, &conflicting_proc)) {
-		std::vector<Task*> conflicting_tasks;
-		Area total_area = 0;
+	// Random tasks of a conflicting processor move to the default processor until its used area fits. The tasks are
+	// collected once per conflicting processor, so the repair takes O(T) per conflict and ends once the list is empty.
+	std::vector<Task*> conflicting_tasks;
+	for (Processor const* conflicting_proc : eval.get_sys().get_platform().get_processors()) {
+		if (mapping.get_used_area(conflicting_proc) <= conflicting_proc->get_maximum_capacity()) {
+			continue;
+		}
+		conflicting_tasks.clear();
 		for (Task* task : tasks) {
 			if (mapping.get_processor(task) == conflicting_proc) {
-				total_area += task->get_area_requirement();
 				conflicting_tasks.push_back(task);
 			}
 		}
 
-		while (total_area > conflicting_proc->get_maximum_capacity()) {
-			size_t swap_idx = rand() % conflicting_tasks.size();
-			total_area -= conflicting_tasks[swap_idx]->get_area_requirement();
+		while (!conflicting_tasks.empty() && mapping.get_used_area(conflicting_proc) > conflicting_proc->get_maximum_capacity()) {
+			size_t swap_idx = random_index(rng, conflicting_tasks.size());
 			mapping.map(conflicting_tasks[swap_idx], default_proc);
 			conflicting_tasks[swap_idx] = conflicting_tasks.back();
 			conflicting_tasks.pop_back();
 		}
 	}
 
-	return std::make_pair(mapping, CostPolicy::compute_cost(mapping, eval));
+	return std::move(mapping);
+}
+
+template <class CostPolicy>
+std::vector<std::pair<DenseMapping, Time>> NSGAIIMapper<CostPolicy>::evaluate(std::vector<DenseMapping>&& mappings, EvaluatorPool& pool) const {
+	std::vector<Time> const costs = CostPolicy::compute_costs(mappings, pool);
+	std::vector<std::pair<DenseMapping, Time>> evaluated;
+	evaluated.reserve(mappings.size());
+	for (size_t i = 0; i < mappings.size(); ++i) {
+		evaluated.emplace_back(std::move(mappings[i]), costs[i]);
+	}
+	return evaluated;
 }
 
 template <class CostPolicy>
-std::pair<Mapping, Time> NSGAIIMapper<CostPolicy>::create_valid_random_mapping(MappingEvaluator const& eval) const {
-	std::vector<Processor*> processors = eval.get_sys().get_platform().get_processors();
+DenseMapping NSGAIIMapper<CostPolicy>::create_valid_random_mapping(MappingEvaluator const& eval, Xoshiro256& rng) const {
+	std::vector<Processor*> const& processors = eval.get_sys().get_platform().get_processors();
 
-	Mapping mapping;
+	DenseMapping mapping(eval.get_sys());
 	for (Task* task : eval.get_sys().get_task_graph().get_tasks()) {
-		mapping.map(task, processors[rand() % processors.size()]);
+		mapping.map(task, processors[random_index(rng, processors.size())]);
 	}
 
-	return evaluate_and_repair(std::move(mapping), eval);
+	return repair(std::move(mapping), eval, rng);
 }
 
 template class NSGAIIMapper<FullEvaluation>;
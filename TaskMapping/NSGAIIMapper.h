@@ -2,55 +2,68 @@
 
 #include "Mapper.h"
 #include "Evaluation.h"
+#include "EvaluatorPool.h"
 
 class FullEvaluation {
 public:
-	static Time compute_cost(Mapping const& mapping, MappingEvaluator const& eval) {
+	static Time compute_cost(DenseMapping const& mapping, MappingEvaluator const& eval) {
 		return eval.compute_cost(mapping);
 	}
+
+	static std::vector<Time> compute_costs(std::span<DenseMapping const> mappings, EvaluatorPool& pool) {
+		return pool.compute_costs(mappings);
+	}
 };
 
 class SummedEvaluation {
 public:
-	static Time compute_cost(Mapping const& mapping, MappingEvaluator const& eval) {
-		std::unordered_map<Processor const*, Time> summed_time;
-		for (Processor* proc : eval.get_sys().get_platform().get_processors()) {
-			summed_time[proc] = 0;
-		}
+	static Time compute_cost(DenseMapping const& mapping, MappingEvaluator const& eval) {
+		std::vector<Time> summed_time(eval.get_costs().nbr_processors(), 0); // Indexed by Device::get_index()
 		for (Task* task : eval.get_sys().get_task_graph().get_tasks()) {
-			Processor const* const proc = mapping.get_processor(task);
-			summed_time[proc] += eval.get_sys().computation_time_ms(task, proc);
+			DeviceIndex const proc = mapping.get_processor_index(task->get_id());
+			summed_time[proc] += eval.get_costs().computation_time(task->get_id(), proc);
 		}
 		for (Edge* edge : eval.get_sys().get_task_graph().get_edges()) {
 			Processor const* const in_proc = mapping.get_processor(edge->get_src());
 			Processor const* const out_proc = mapping.get_processor(edge->get_snk());
 
 			Time const transfer_time = eval.get_sys().transaction_time_ms(edge->get_src()->get_output_size(), in_proc, out_proc);
-			summed_time[in_proc] += transfer_time;
-			summed_time[out_proc] += transfer_time;
+			summed_time[in_proc->get_index()] += transfer_time;
+			summed_time[out_proc->get_index()] += transfer_time;
 		}
 		Time max = 0;
-		for (Processor* proc : eval.get_sys().get_platform().get_processors()) {
-			if (max < summed_time[proc]) {
-				max = summed_time[proc];
+		for (Time const& time : summed_time) {
+			if (max < time) {
+				max = time;
 			}
 		}
 
 		return max;
 	}
+
+	static std::vector<Time> compute_costs(std::span<DenseMapping const> mappings, EvaluatorPool& pool) {
+		std::vector<Time> costs(mappings.size());
+		pool.parallel_for(mappings.size(), [&](size_t i, size_t worker) {
+			costs[i] = compute_cost(mappings[i], pool.get_evaluator(worker));
+		});
+		return costs;
+	}
 };
 
 template <class CostPolicy = FullEvaluation> class NSGAIIMapper : public Mapper {
 	mutable Processor* default_proc = nullptr;
 	size_t const GENERATIONS;
+	RandomStreams const streams;
 public:
-	NSGAIIMapper(size_t generations = 500) : GENERATIONS(generations) {};
+	NSGAIIMapper(size_t generations = 500, RandomStreams const& streams = RandomStreams()) : GENERATIONS(generations), streams(streams) {};
 	Mapping get_task_mapping(System const&) const;
+	DenseMapping get_dense_task_mapping(System const&) const;
 protected:
 	void init(System const&) const;
-	std::pair<Mapping, Time> evaluate_and_repair(Mapping&& mapping, MappingEvaluator const& eval) const;
-	std::pair<Mapping, Time> create_valid_random_mapping(MappingEvaluator const& eval) const;
-	std::vector<MappingView> select(std::vector<std::pair<Mapping, Time>> const& population, size_t parent_population_size) const;
-	void mutate(std::vector<MappingView>& parent_selection, System const& sys) const;
-	std::vector<std::pair<Mapping, Time>> crossover(std::vector<MappingView> const& parent_selection, std::vector<GraphElement> const& sorted_tasks, MappingEvaluator const& eval) const;
+	DenseMapping repair(DenseMapping&& mapping, MappingEvaluator const& eval, Xoshiro256& rng) const;
+	std::vector<std::pair<DenseMapping, Time>> evaluate(std::vector<DenseMapping>&& mappings, EvaluatorPool& pool) const;
+	DenseMapping create_valid_random_mapping(MappingEvaluator const& eval, Xoshiro256& rng) const;
+	std::vector<DenseMapping> select(std::vector<std::pair<DenseMapping, Time>> const& population, size_t parent_population_size, Xoshiro256& rng) const;
+	void mutate(std::vector<DenseMapping>& parent_selection, System const& sys, Xoshiro256& rng) const;
+	std::vector<DenseMapping> crossover(std::vector<DenseMapping> const& parent_selection, std::vector<GraphElement> const& sorted_tasks, MappingEvaluator const& eval, Xoshiro256& rng) const;
 };
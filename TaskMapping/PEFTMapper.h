@@ -2,6 +2,7 @@
 
 #include "TaskMapperWithSchedule.h"
 #include "TopologicalSorting.h"
+#include "CostTable.h"
 
 #include <unordered_map>
 #include <list>
@@ -12,55 +13,62 @@ public:
 		Mapping mapping;
 		task_schedule = std::priority_queue<std::pair<Time, Task*>>();
 
+		FrozenTaskGraph const& task_graph = sys.get_task_graph().freeze();
+		CostTable const costs(sys);
 		std::vector<Processor*> const& processors = sys.get_platform().get_processors();
+		size_t const nbr_procs = processors.size();
 
-		std::unordered_map<Task*, std::unordered_map<Processor*, Time>> OCT;
-		std::unordered_map<Task*, Time> rank;
-        std::unordered_map<Task*, int> dependencies;
+		// Optimistic cost table, row-major by task id
+		std::vector<Time> OCT(task_graph.nbr_tasks() * nbr_procs, 0);
+		std::vector<Time> rank(task_graph.nbr_tasks(), 0);
+        std::vector<size_t> dependencies(task_graph.nbr_tasks(), 0);
 
         std::priority_queue<std::pair<Time, Task*>> ready_list;
 
-		BFSSorting topsort(sys.get_task_graph(), false);
+		BFSSorting topsort(task_graph, false);
 		auto& sorted_elements = topsort.get_sorted_elements();
 		for (auto rit = sorted_elements.rbegin(); rit != sorted_elements.rend(); ++rit) {
 			Task* task = rit->get_task();
-			auto& OCTtask = OCT[task];
+			TaskId const task_id = task->get_id();
+			Time* const OCTtask = &OCT[task_id * nbr_procs];
 
 			Time r = 0;
 			int nbr_compatible_proc = 0;
 
-			for (Processor* proc : processors) {
-				if (sys.is_compatible(task, proc)) {
+			for (size_t p = 0; p < nbr_procs; ++p) {
+				Processor* proc = processors[p];
+				if (costs.is_compatible(task, proc)) {
 					Time max_succ = 0;
-					for (Task* succ : task->compute_successors()) {
+					for (EdgeId e : task_graph.get_edges_out(task_id)) { // Parallel edges do not change the maximum
+						TaskId const succ_id = task_graph.get_edge_snk(e);
 						Time min_proc = std::numeric_limits<Time>::infinity();
-						for (Processor* succ_proc : processors) {
-							if (sys.is_compatible(succ, succ_proc)) {
-								min_proc = std::min(min_proc, OCT[succ][succ_proc] + sys.computation_time_ms(succ, succ_proc) + sys.transaction_time_ms(task->get_output_size(), proc->get_default_memory(), succ_proc->get_default_memory()));
+						for (size_t succ_p = 0; succ_p < nbr_procs; ++succ_p) {
+							Processor* succ_proc = processors[succ_p];
+							if (costs.is_compatible(succ_id, succ_p)) {
+								min_proc = std::min(min_proc, OCT[succ_id * nbr_procs + succ_p] + costs.computation_time(succ_id, succ_p) + costs.edge_time(e, proc->get_default_memory()->get_index(), succ_proc->get_default_memory()->get_index()));
 							}
 						}
 						max_succ = std::max(max_succ, min_proc);
 					}
 
-					OCTtask[proc] = max_succ;
+					OCTtask[p] = max_succ;
 					r += max_succ;
 					++nbr_compatible_proc;
 				}
 				else {
-					OCTtask[proc] = std::numeric_limits<Time>::infinity();
+					OCTtask[p] = std::numeric_limits<Time>::infinity();
 				}
 			}
 
-			rank[task] = r / nbr_compatible_proc;
+			rank[task_id] = r / nbr_compatible_proc;
 
-            if (task->get_edges_in().size() > 1) {
-                dependencies[task] = task->get_edges_in().size();
-            } else if (task->get_edges_in().size() == 0) {
-                ready_list.push({ rank[task], task });
+            dependencies[task_id] = task_graph.get_in_degree(task_id);
+            if (dependencies[task_id] == 0) {
+                ready_list.push({ rank[task_id], task });
             }
 		}
 
-		std::unordered_map<Task*, Time> scheduled_finish_time;
+		std::vector<Time> scheduled_finish_time(task_graph.nbr_tasks(), 0);
 		std::unordered_map<Processor*, std::list<std::pair<Time, Time>> > free_slots;
 		std::unordered_map<Processor*, Area> remaining_area;
 		for (Processor* proc : processors) {
@@ -76,12 +84,13 @@ public:
 			std::pair<Time, Time> min_slot(0, std::numeric_limits<Time>::infinity());
 			Time min_oeft = std::numeric_limits<Time>::infinity();
 
-			for (Processor* proc : processors) {
-				if (sys.is_compatible(task, proc) && (!proc->has_maximum_capacity() || task->get_area_requirement() <= remaining_area[proc])) {
+			for (size_t p = 0; p < nbr_procs; ++p) {
+				Processor* proc = processors[p];
+				if (costs.is_compatible(task, proc) && (!proc->has_maximum_capacity() || task_graph.get_area_requirement(task->get_id()) <= remaining_area[proc])) {
 					Time min_start_time = 0;
-					for (Edge* e : task->get_edges_in()) {
-                        assert(scheduled_finish_time.contains(e->get_src()));
-						min_start_time = std::max(min_start_time, scheduled_finish_time.at(e->get_src()) + sys.transaction_time_ms(e->get_src()->get_output_size(), mapping.get_mem_out(e->get_src()), proc->get_default_memory()));
+					for (EdgeId e : task_graph.get_edges_in(task->get_id())) {
+						TaskId const src_id = task_graph.get_edge_src(e);
+						min_start_time = std::max(min_start_time, scheduled_finish_time[src_id] + costs.edge_time(e, mapping.get_mem_out(task_graph.get_task(src_id))->get_index(), proc->get_default_memory()->get_index()));
 					}
 
                     if (min_start_time == std::numeric_limits<Time>::infinity()) {
@@ -89,9 +98,9 @@ public:
                     }
 
 					for (auto& slot : free_slots[proc]) {
-						Time finish_time = std::max(min_start_time, slot.first) + sys.computation_time_ms(task, proc);
+						Time finish_time = std::max(min_start_time, slot.first) + costs.computation_time(task, proc);
 						if (finish_time <= slot.second) {
-							Time const oeft = finish_time + OCT[task][proc];
+							Time const oeft = finish_time + OCT[task->get_id() * nbr_procs + p];
 							if (oeft < min_oeft) {
 								min_slot = { std::max(min_start_time, slot.first), finish_time };
 								min_proc = proc;
@@ -119,19 +128,18 @@ public:
 			}
 
 			if (min_proc->has_maximum_capacity()) {
-				remaining_area[min_proc] -= task->get_area_requirement();
+				remaining_area[min_proc] -= task_graph.get_area_requirement(task->get_id());
 			}
 
-			scheduled_finish_time[task] = min_slot.second;
+			scheduled_finish_time[task->get_id()] = min_slot.second;
 			mapping.map(task, min_proc);
 
 			ready_list.pop();
-			for (Task* succ : task->compute_successors()) {
-				if (!dependencies.contains(succ) || dependencies.at(succ) == 1) {
-					ready_list.push({ rank[succ],succ });
-                } else {
-                    --dependencies[succ];
-                }
+			for (EdgeId e : task_graph.get_edges_out(task->get_id())) {
+				TaskId const succ_id = task_graph.get_edge_snk(e);
+				if (--dependencies[succ_id] == 0) {
+					ready_list.push({ rank[succ_id], task_graph.get_task(succ_id) });
+				}
 			}
 		}
 
@@ -0,0 +1,80 @@
+#include "Parallel.h"
+
+ThreadPool::ThreadPool(size_t nbr_threads) {
+	for (size_t worker = 1; worker < nbr_threads; ++worker) {
+		threads.emplace_back(&ThreadPool::work, this, worker);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	job_available.notify_all();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+void ThreadPool::run(std::function<void(size_t)> const& new_job) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &new_job;
+		running = threads.size();
+		error = nullptr;
+		++generation;
+	}
+	job_available.notify_all();
+
+	std::exception_ptr own_error;
+	try {
+		new_job(0);
+	}
+	catch (...) {
+		own_error = std::current_exception();
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+	job_finished.wait(lock, [this] { return running == 0; });
+	job = nullptr;
+	if (own_error) {
+		std::rethrow_exception(own_error);
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+void ThreadPool::work(size_t worker) {
+	size_t seen_generation = 0;
+	while (true) {
+		std::function<void(size_t)> const* current_job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			job_available.wait(lock, [&] { return stop || generation != seen_generation; });
+			if (stop) {
+				return;
+			}
+			seen_generation = generation;
+			current_job = job;
+		}
+
+		std::exception_ptr job_error;
+		try {
+			(*current_job)(worker);
+		}
+		catch (...) {
+			job_error = std::current_exception();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (job_error && !error) {
+				error = job_error;
+			}
+			--running;
+		}
+		job_finished.notify_one();
+	}
+}
\ No newline at end of file
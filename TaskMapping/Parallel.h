@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+// Fixed set of worker threads for data parallel loops. The calling thread takes part as worker 0.
+class ThreadPool {
+public:
+	static size_t default_size() { return std::max(std::thread::hardware_concurrency(), 1u); }
+
+	ThreadPool(size_t nbr_threads = default_size());
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	size_t size() const { return threads.size() + 1; }
+
+	// Calls func(index, worker) for every index in [0, n) and returns when all calls are done.
+	// worker in [0, size()) identifies the executing thread. Must not be called from within func.
+	template <class Func>
+	void parallel_for(size_t n, Func&& func) {
+		if (n == 0) {
+			return;
+		}
+		if (threads.empty() || n == 1) {
+			for (size_t i = 0; i < n; ++i) {
+				func(i, size_t(0));
+			}
+			return;
+		}
+
+		std::atomic<size_t> next_index = 0;
+		run([&](size_t worker) {
+			for (size_t i = next_index++; i < n; i = next_index++) {
+				func(i, worker);
+			}
+		});
+	}
+
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable job_available;
+	std::condition_variable job_finished;
+	std::function<void(size_t)> const* job = nullptr;
+	size_t generation = 0;
+	size_t running = 0;
+	bool stop = false;
+	std::exception_ptr error;
+
+	// Runs job on every worker and waits for all of them, rethrows the first exception
+	void run(std::function<void(size_t)> const& job);
+	void work(size_t worker);
+};
\ No newline at end of file
@@ -123,7 +123,7 @@ private:
 		}
 	}
 
-	std::optional<Task*> get_max_task(std::vector<Edge*> const& edges) const {
+	std::optional<Task*> get_max_task(std::span<Edge* const> edges) const {
 		auto const it = std::max_element(edges.begin(), edges.end(), [this](Edge* first, Edge* second) {return this->subgraph_weights.at(first->get_snk()) < this->subgraph_weights.at(second->get_snk());});
 		return (it == edges.end()) ? std::nullopt : std::optional<Task*>{ (*it)->get_snk() };
 	}
@@ -184,7 +184,11 @@ public:
 	Mapping get_task_mapping(System const& sys) const {
 		Mapping mapping;
 
-		std::vector<Task*> const src_tasks(sys.get_task_graph().get_src().begin(), sys.get_task_graph().get_src().end());
+		FrozenTaskGraph const& graph = sys.get_task_graph().freeze();
+		std::vector<Task*> src_tasks;
+		for (TaskId task : graph.get_src()) {
+			src_tasks.push_back(graph.get_task(task));
+		}
 
 		std::vector<PathTree> path_trees;
 		add_device_pair(path_trees, "CPU", "Main_RAM", src_tasks, sys);
@@ -5,26 +5,33 @@
 #include <cassert>
 #include <vector>
 #include <string>
-#include <unordered_map>
+#include <limits>
+#include <algorithm>
 
 enum class DeviceType { NONE, MEMORY, PROCESSOR };
 
 class Device {
+	friend class Platform;
+
 	std::string label;
 	DeviceType type;
 	bool streaming_allowed;
+	size_t index = 0; // Position in Platform::get_processors() or Platform::get_memories()
+	size_t id = 0; // Position in Platform::get_devices()
 public:
 	Device(std::string const& label, DeviceType const& type, bool streaming_allowed) : label(label), type(type), streaming_allowed(streaming_allowed) {}
     virtual ~Device(){};
 
 	std::string const& get_label() const { return label; }
+	size_t get_index() const { return index; }
+	size_t get_id() const { return id; }
 	bool is_streaming_device() const { return streaming_allowed; }
 	virtual DataRate data_movement_rate_MBps() const = 0;
 };
 
 class Memory;
 
-class Processor : public Device {
+class Processor final : public Device {
 	DataRate serial_processing_rate_MBps = 0;
 	DataRate parallel_processing_rate_MBps = 0;
 	Area capacity = std::numeric_limits<Area>::infinity();
@@ -70,7 +77,7 @@ public:
 	DataRate data_movement_rate_MBps() const { return parallel_processing_rate_MBps; }
 };
 
-class Memory : public Device {
+class Memory final : public Device {
 	DataRate data_rate_MBps = 0;
 public:
 	Memory(std::string const& label, bool streaming_allowed) : Device(label, DeviceType::MEMORY, streaming_allowed) {}
@@ -88,6 +95,7 @@ public:
 	Platform(Platform&& other) noexcept :
 		processors(std::move(other.processors)),
 		memories(std::move(other.memories)),
+		devices(std::move(other.devices)),
 		datarates(std::move(other.datarates))
 	{}
 
@@ -102,14 +110,19 @@ public:
 
 	std::vector<Processor*> const& get_processors() const { return processors; }
 	std::vector<Memory*> const& get_memories() const { return memories; }
+	std::vector<Device*> const& get_devices() const { return devices; }
 
 	Processor* create_processor(std::string const& label, bool streaming_allowed = false) {
 		processors.push_back(new Processor(label, streaming_allowed));
+		processors.back()->index = processors.size() - 1;
+		add_device(processors.back());
 		return processors.back();
 	}
 
 	Memory* create_memory(std::string const& label, bool streaming_allowed = true) {
 		memories.push_back(new Memory(label, streaming_allowed));
+		memories.back()->index = memories.size() - 1;
+		add_device(memories.back());
 		return memories.back();
 	}
 
@@ -123,24 +136,43 @@ public:
 	}
 
     void set_directed_connection(Device const* dev1, Device const* dev2, DataRate const& rate) {
-        datarates[dev1][dev2] = rate;
+		if (dev1 != dev2) { // Transfers within a device are always free
+			datarates[dev1->id * devices.size() + dev2->id] = rate;
+		}
     }
 
 	DataRate transfer_rate_MBps(Device const* dev1, Device const* dev2) const {
-		if (dev1 == dev2) {
-			return std::numeric_limits<DataRate>::infinity();
+		if (!dev1 || !dev2) {
+			return dev1 == dev2 ? std::numeric_limits<DataRate>::infinity() : 0;
 		}
-		if (datarates.contains(dev1)) {
-			auto const& second_level = datarates.at(dev1);
-			if (second_level.contains(dev2)) {
-				return second_level.at(dev2);
-			}
-		}
-		return 0;
+		return transfer_rate_MBps(dev1->id, dev2->id);
+	}
+
+	// By device id, 0 if not connected and infinity within the same device
+	DataRate transfer_rate_MBps(size_t dev1, size_t dev2) const {
+		return datarates[dev1 * devices.size() + dev2];
 	}
 
 private:
+	// Devices are addressed as bits of a DeviceMask by their id, so a platform holds at most 64 devices
+	void add_device(Device* device) {
+		assert(devices.size() < 64);
+		size_t const old_size = devices.size();
+		device->id = old_size;
+		devices.push_back(device);
+
+		// Grow the matrix by one row and column
+		size_t const new_size = devices.size();
+		std::vector<DataRate> new_datarates(new_size * new_size, 0);
+		for (size_t i = 0; i < old_size; ++i) {
+			std::copy_n(datarates.begin() + i * old_size, old_size, new_datarates.begin() + i * new_size);
+		}
+		new_datarates[device->id * new_size + device->id] = std::numeric_limits<DataRate>::infinity();
+		datarates = std::move(new_datarates);
+	}
+
 	std::vector<Processor*> processors;
 	std::vector<Memory*> memories;
-    std::unordered_map < Device const*, std::unordered_map<Device const*, DataRate> > datarates;
+	std::vector<Device*> devices; // Processors and memories in order of creation
+	std::vector<DataRate> datarates; // Row-major devices.size() x devices.size() matrix indexed by device id
 };
\ No newline at end of file
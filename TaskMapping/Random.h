@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <string_view>
+
+// xoshiro256++ (Blackman and Vigna). 32 bytes of state without any locking, several times faster than std::mt19937 and
+// good enough for sampling. Satisfies UniformRandomBitGenerator, so it can be used with the <random> distributions.
+class Xoshiro256 {
+	std::uint64_t state[4];
+
+	static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+	typedef std::uint64_t result_type;
+
+	explicit Xoshiro256(std::uint64_t seed = 0) { this->seed(seed); }
+
+	// Expands the seed with splitmix64, so similar seeds give unrelated states
+	void seed(std::uint64_t seed) {
+		for (std::uint64_t& s : state) {
+			seed += 0x9e3779b97f4a7c15;
+			s = mix(seed);
+		}
+	}
+
+	// Finalizer of splitmix64, a bijection that spreads every input bit over the whole output
+	static constexpr std::uint64_t mix(std::uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+		return z ^ (z >> 31);
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()() {
+		std::uint64_t const result = rotl(state[0] + state[3], 23) + state[0];
+		std::uint64_t const t = state[1] << 17;
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotl(state[3], 45);
+		return result;
+	}
+
+	// Value in [0, n) for n < 2^32, by a multiplication instead of a division
+	std::uint32_t below(std::uint32_t n) {
+		return static_cast<std::uint32_t>((((*this)() >> 32) * n) >> 32);
+	}
+};
+
+// Value in [0, n). Engines with below() skip the division, others keep their rng() % n sequences.
+template <class Engine>
+size_t random_index(Engine& rng, size_t n) {
+	if constexpr (requires { rng.below(std::uint32_t(n)); }) {
+		return rng.below(static_cast<std::uint32_t>(n));
+	}
+	else {
+		return rng() % n;
+	}
+}
+
+// Independent random streams derived from one seed. Components fork their own streams by a key (run, mapper label,
+// annealing run, ...) and draw from Xoshiro256 engines seeded by the hash of the path of keys. What a component draws
+// therefore depends neither on how much other components drew before nor on the thread it runs on, so results are
+// reproducible from the seed for any number of threads. Copies are cheap, a stream is a 64 bit value.
+class RandomStreams {
+	std::uint64_t key_hash;
+
+	struct Hashed {};
+	constexpr RandomStreams(std::uint64_t key_hash, Hashed) : key_hash(key_hash) {}
+
+public:
+	constexpr explicit RandomStreams(std::uint64_t seed = 0) : key_hash(Xoshiro256::mix(seed)) {}
+
+	constexpr RandomStreams fork(std::uint64_t key) const {
+		return RandomStreams(Xoshiro256::mix(key_hash + Xoshiro256::mix(key + 0x9e3779b97f4a7c15)), Hashed{});
+	}
+
+	// Keyed by a label, hashed with FNV-1a
+	constexpr RandomStreams fork(std::string_view key) const {
+		std::uint64_t hash = 0xcbf29ce484222325;
+		for (char c : key) {
+			hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+		}
+		return fork(hash);
+	}
+
+	Xoshiro256 stream(std::uint64_t key = 0) const { return Xoshiro256(fork(key).key_hash); }
+	Xoshiro256 stream(std::string_view key) const { return Xoshiro256(fork(key).key_hash); }
+
+	// For interfaces that take a plain seed, e.g. std::seed_seq
+	constexpr std::uint64_t seed(std::uint64_t key = 0) const { return fork(key).key_hash; }
+};
\ No newline at end of file
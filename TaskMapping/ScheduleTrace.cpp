@@ -0,0 +1,166 @@
+#include "ScheduleTrace.h"
+
+#include <fstream>
+#include <map>
+#include <bit>
+#include <cstdio>
+
+namespace {
+	// Writes the events one by one, so the trace is never held in memory
+	class TraceWriter {
+		std::ofstream out;
+		bool first = true;
+
+		void separate() {
+			out << (first ? "\n" : ",\n");
+			first = false;
+		}
+
+		void write_string(std::string const& s) {
+			out << '"';
+			for (char c : s) {
+				if (c == '"' || c == '\\') {
+					out << '\\' << c;
+				}
+				else if (static_cast<unsigned char>(c) < 0x20) {
+					char escaped[8];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+					out << escaped;
+				}
+				else {
+					out << c;
+				}
+			}
+			out << '"';
+		}
+
+	public:
+		TraceWriter(std::string const& path) : out(path) {
+			out.precision(17);
+			out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		}
+
+		~TraceWriter() {
+			out << "\n]}\n";
+		}
+
+		bool is_open() const { return out.is_open(); }
+
+		void track_name(size_t track, std::string const& name, size_t sort_index) {
+			separate();
+			out << "{\"ph\":\"M\",\"pid\":0,\"tid\":" << track << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+			write_string(name);
+			out << "}}";
+			separate();
+			out << "{\"ph\":\"M\",\"pid\":0,\"tid\":" << track << ",\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":" << sort_index << "}}";
+		}
+
+		// Trace timestamps are in microseconds
+		void begin_event(size_t track, std::string const& name, char const* category, Time start_time_ms, Time end_time_ms) {
+			separate();
+			out << "{\"ph\":\"X\",\"pid\":0,\"tid\":" << track << ",\"name\":";
+			write_string(name);
+			out << ",\"cat\":\"" << category << "\",\"ts\":" << start_time_ms * 1000 << ",\"dur\":" << (end_time_ms - start_time_ms) * 1000 << ",\"args\":{";
+		}
+
+		void arg(char const* key, std::string const& value, bool first_arg = false) {
+			out << (first_arg ? "\"" : ",\"") << key << "\":";
+			write_string(value);
+		}
+
+		void arg(char const* key, size_t value, bool first_arg = false) {
+			out << (first_arg ? "\"" : ",\"") << key << "\":" << value;
+		}
+
+		void end_event() {
+			out << "}}";
+		}
+	};
+}
+
+// Tasks appear on their processor and, as accesses, on their input and output memory, edges on both memories. Tasks of
+// a streaming subgraph are merged into one event per device. Transfers of zero duration are left out.
+void export_schedule_trace(System const& sys, Mapping const& mapping, std::string const& output_filename, EvaluationLog const& log) {
+	TaskGraph const& graph = sys.get_task_graph();
+	Platform const& platform = sys.get_platform();
+
+	TraceWriter trace("results/" + output_filename + ".json");
+	if (!trace.is_open()) {
+		return;
+	}
+
+	// Tracks by Device::get_id(), processors first
+	size_t sort_index = 0;
+	for (Processor const* processor : platform.get_processors()) {
+		trace.track_name(processor->get_id(), processor->get_label(), sort_index++);
+	}
+	for (Memory const* memory : platform.get_memories()) {
+		trace.track_name(memory->get_id(), memory->get_label(), sort_index++);
+	}
+
+	struct StreamedSubgraph {
+		Task* first_task;
+		size_t nbr_tasks;
+		DeviceMask devices;
+	};
+	std::map<size_t, StreamedSubgraph> subgraphs; // By subgraph number of the log
+
+	for (Task* task : graph.get_tasks()) {
+		if (!log.contains(task) || !mapping.contains(task)) {
+			continue;
+		}
+		Processor const* processor = mapping.get_processor(task);
+		Memory const* mem_in = mapping.get_mem_in(task);
+		Memory const* mem_out = mapping.get_mem_out(task);
+
+		if (size_t const subgraph = log.get_subgraph(task)) {
+			auto [it, inserted] = subgraphs.try_emplace(subgraph, StreamedSubgraph{ task, 0, 0 });
+			++it->second.nbr_tasks;
+			it->second.devices |= (DeviceMask(1) << processor->get_id()) | (DeviceMask(1) << mem_in->get_id()) | (DeviceMask(1) << mem_out->get_id());
+			continue;
+		}
+
+		Device const* devices[] = { processor, mem_in, mem_out };
+		size_t const nbr_devices = (mem_in == mem_out) ? 2 : 3;
+		for (size_t d = 0; d < nbr_devices; ++d) {
+			trace.begin_event(devices[d]->get_id(), task->get_label(), d == 0 ? "task" : "access", log.start_time_ms(task), log.end_time_ms(task));
+			trace.arg("task", task->get_id(), true);
+			trace.arg("processor", processor->get_label());
+			trace.arg("mem_in", mem_in->get_label());
+			trace.arg("mem_out", mem_out->get_label());
+			trace.end_event();
+		}
+	}
+
+	for (auto const& [subgraph, streamed] : subgraphs) {
+		for (DeviceMask mask = streamed.devices; mask; mask &= mask - 1) {
+			trace.begin_event(std::countr_zero(mask), "Streaming subgraph " + std::to_string(subgraph), "subgraph", log.start_time_ms(streamed.first_task), log.end_time_ms(streamed.first_task));
+			trace.arg("tasks", streamed.nbr_tasks, true);
+			trace.arg("first_task", streamed.first_task->get_label());
+			trace.end_event();
+		}
+	}
+
+	for (Edge* edge : graph.get_edges()) {
+		if (!log.contains(edge) || !mapping.contains(edge->get_src()) || !mapping.contains(edge->get_snk())) {
+			continue;
+		}
+		size_t const subgraph = log.get_subgraph(edge->get_src());
+		if ((subgraph && subgraph == log.get_subgraph(edge->get_snk())) || log.end_time_ms(edge) <= log.start_time_ms(edge)) {
+			continue; // Streamed within a subgraph or no transfer
+		}
+		Memory const* mem_out = mapping.get_mem_out(edge->get_src());
+		Memory const* mem_in = mapping.get_mem_in(edge->get_snk());
+		std::string const name = edge->get_src()->get_label() + " -> " + edge->get_snk()->get_label();
+		for (Memory const* memory : { mem_out, mem_in }) {
+			trace.begin_event(memory->get_id(), name, "transfer", log.start_time_ms(edge), log.end_time_ms(edge));
+			trace.arg("edge", edge->get_id(), true);
+			trace.arg("from", mem_out->get_label());
+			trace.arg("to", mem_in->get_label());
+			trace.end_event();
+			if (mem_in == mem_out) {
+				break;
+			}
+		}
+	}
+}
\ No newline at end of file
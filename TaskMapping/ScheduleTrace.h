@@ -0,0 +1,8 @@
+#pragma once
+#include "System.h"
+#include "Mapping.h"
+#include "EvaluationLog.h"
+
+// Writes the logged schedule as Chrome trace events to results/<output_filename>.json, which chrome://tracing and
+// Perfetto (ui.perfetto.dev) open as a timeline with one track per processor and memory
+void export_schedule_trace(System const& sys, Mapping const& mapping, std::string const& output_filename, EvaluationLog const& log);
\ No newline at end of file
@@ -1,10 +1,10 @@
 #pragma once
 #include "TaskGraph.h"
+#include "FrozenTaskGraph.h"
 #include "TopologicalSorting.h"
 
 #include "SafeBoostHeaders.h"
 #include <unordered_map>
-#include <unordered_set>
 #include <fstream>
 
 enum class SeriesParallelOperationType { SERIES, PARALLEL, EDGE };
@@ -100,17 +100,18 @@ class SeriesParallelDecomposition {
 	std::vector<SeriesParallelOperation*> inner_nodes;
 	std::vector<SeriesParallelOperation*> leaves;
 
-	std::unordered_set<SeriesParallelOperation*> root_set;
+	std::vector<SeriesParallelOperation*> roots; // In order of extraction, the complete root last
 
-	std::unordered_map<Task*, int> missing_inputs;
+	FrozenTaskGraph const& task_graph;
+	std::vector<size_t> missing_inputs;
 public:
 
-	SeriesParallelDecomposition(TaskGraph const& task_graph) {
-		create_tree(task_graph);
+	SeriesParallelDecomposition(FrozenTaskGraph const& task_graph) : task_graph(task_graph), missing_inputs(task_graph.nbr_tasks(), 0) {
+		create_tree();
 	}
 
 	~SeriesParallelDecomposition() {
-		for (SeriesParallelOperation* forest_root : root_set) {
+		for (SeriesParallelOperation* forest_root : roots) {
 			delete forest_root;
 		}
 	}
@@ -178,11 +179,13 @@ private:
 		return op;
 	}
 
-	SeriesParallelOperation* create_parallel(std::vector<Edge*> const& children) {
+	SeriesParallelOperation* create_parallel(Task* src, std::vector<Task*> const& children) {
 
-		std::unordered_map<Task*, std::vector<SeriesParallelOperation*> > wavefront;
-		for (Edge* child_edge : children) {
-			wavefront[child_edge->get_snk()].push_back(create_leaf(child_edge->get_src(), child_edge->get_snk()));
+		// Keyed by task id (the back task or nbr_tasks() for the end) so that the traversal order does not depend on where tasks are allocated
+		std::unordered_map<TaskId, std::vector<SeriesParallelOperation*> > wavefront;
+		auto const key = [this](Task* task) { return task ? task->get_id() : static_cast<TaskId>(task_graph.nbr_tasks()); };
+		for (Task* child : children) {
+			wavefront[key(child)].push_back(create_leaf(src, child));
 		}
 
 		while (true) {
@@ -210,7 +213,7 @@ private:
 						if (edgeop != wfpair.second.front()) {
 							wavefront.erase(wfpair.first);
 
-							wavefront[edgeop->get_back()].push_back(edgeop);
+							wavefront[key(edgeop->get_back())].push_back(edgeop);
 							change = true;
 							break;
 						}
@@ -223,12 +226,9 @@ private:
 			assert(it->second.size() == 1);
 
 			auto faulty_op = it->second.front();
-			root_set.insert(faulty_op);
-			if (missing_inputs.contains(faulty_op->get_back())) {
-				missing_inputs[faulty_op->get_back()] += faulty_op->get_parallel_out();
-			}
-			else {
-				missing_inputs[faulty_op->get_back()] = faulty_op->get_parallel_out();
+			roots.push_back(faulty_op);
+			if (faulty_op->get_back()) {
+				missing_inputs[faulty_op->get_back()->get_id()] += faulty_op->get_parallel_out();
 			}
 			wavefront.erase(it);
 		}
@@ -239,17 +239,22 @@ private:
 
 	SeriesParallelOperation* grow_operation(SeriesParallelOperation* op) {
 		Task* next = op->get_back();
-		while (next && next->get_edges_in().size()-(missing_inputs.contains(next) ? missing_inputs.at(next) : 0) <= op->get_parallel_out()) { // Could be root
-			if (next->get_edges_out().size() == 0) {
+		while (next && task_graph.get_in_degree(next->get_id()) - missing_inputs[next->get_id()] <= op->get_parallel_out()) { // Could be root
+			std::span<EdgeId const> const edges_out = task_graph.get_edges_out(next->get_id());
+			if (edges_out.size() == 0) {
 				op = create_series(op, create_leaf(next, nullptr));
 				next = nullptr;
 			}
-			else if (next->get_edges_out().size() == 1) {
-				op = create_series(op, create_leaf(next, next->get_edges_out()[0]->get_snk()));
+			else if (edges_out.size() == 1) {
+				op = create_series(op, create_leaf(next, task_graph.get_task(task_graph.get_edge_snk(edges_out[0]))));
 				next = op->get_back();
 			}
 			else {
-				SeriesParallelOperation* parop = create_parallel(next->get_edges_out());
+				std::vector<Task*> children;
+				for (EdgeId edge : edges_out) {
+					children.push_back(task_graph.get_task(task_graph.get_edge_snk(edge)));
+				}
+				SeriesParallelOperation* parop = create_parallel(next, children);
 				op = create_series(op, parop);
 				next = op->get_back();
 			}
@@ -261,21 +266,17 @@ private:
 		return new SeriesParallelOperation(op, child, SeriesParallelOperationType::SERIES);
 	}
 
-	bool create_tree(TaskGraph const& task_graph) {
+	bool create_tree() {
 		SeriesParallelOperation* root;
 		if (task_graph.get_src().size() == 1) {
-			root = grow_operation(create_leaf(nullptr,*task_graph.get_src().begin()));
+			root = grow_operation(create_leaf(nullptr, task_graph.get_task(task_graph.get_src().front())));
 		}
 		else {
-			std::vector<Edge*> start_edges;
-			for (Task* task : task_graph.get_src()) {
-				start_edges.push_back(new Edge(nullptr, task));
-			}
-			root = create_parallel(start_edges);
-
-			for (Edge* e : start_edges) {
-				delete e;
+			std::vector<Task*> start_tasks;
+			for (TaskId task : task_graph.get_src()) {
+				start_tasks.push_back(task_graph.get_task(task));
 			}
+			root = create_parallel(nullptr, start_tasks);
 
 			if (root->get_back() != nullptr) {
 				root = grow_operation(root);
@@ -284,8 +285,8 @@ private:
 
 		assert(root->get_back() == nullptr);
 
-		root_set.insert(root);
-		for (auto& rootop : root_set) {
+		roots.push_back(root);
+		for (auto& rootop : roots) {
 			add_inner_nodes(rootop);
 		}
 		return true;
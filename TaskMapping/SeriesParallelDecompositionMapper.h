@@ -10,7 +10,7 @@ template <class Policies> class SeriesParallelDecompositionMapper : public Decom
 public:
 	SeriesParallelDecompositionMapper(bool map_single_tasks = true): map_single_tasks(map_single_tasks) {}
 protected:
-	Decomposition create_decomposition(TaskGraph const& task_graph) const {		
+	Decomposition create_decomposition(FrozenTaskGraph const& task_graph) const {		
 		Decomposition decomposition;
 		SeriesParallelDecomposition spdtree(task_graph);
 #ifndef NDEBUG
@@ -1,43 +1,82 @@
 #include "SimulatedAnnealingMapper.h"
 #include "GreedyMapper.h"
 #include "Evaluation.h"
+#include "IncrementalEvaluation.h"
+#include "LowerBound.h"
+#include "EvaluatorPool.h"
 
 #include <cmath>
 #include <iomanip>
 
 #define NO_SA_LOG
 
+// The annealing runs are independent and run in parallel. Run i draws from streams.stream(i) and ties between the runs
+// go to the lower index, so the result only depends on the streams and not on the number of threads.
 Mapping SimulatedAnnealingMapper::get_task_mapping(System const& sys) const {
 	size_t const annealing_runs = 10;
 	size_t const iterations_per_temperature = 50;//sys.get_task_graph().get_tasks().size()* (sys.get_platform().get_processors().size() - 1);
-	Temperature const final_temperature = get_normalized_final_temperature(sys);
+	EvaluatorPool pool(sys, std::min(ThreadPool::default_size(), annealing_runs));
+	std::vector<std::unique_ptr<IncrementalEvaluator>> inc_evals; // By worker
+	std::vector<std::unique_ptr<LowerBoundEvaluator>> bound_evals; // By worker
+	for (size_t worker = 0; worker < pool.size(); ++worker) {
+		inc_evals.push_back(std::make_unique<IncrementalEvaluator>(pool.get_evaluator(worker)));
+		bound_evals.push_back(std::make_unique<LowerBoundEvaluator>(pool.get_context()));
+	}
+	Temperature const final_temperature = get_normalized_final_temperature(sys, pool.get_context().get_costs());
 
 	GreedyMapper base_mapper({ "CPU", "Main_RAM" });
-	Mapping best_mapping;
-	Time best_cost = std::numeric_limits<Time>::infinity();
-
-	for (size_t run = 0; run < annealing_runs; ++run) {
-		Mapping current_best_mapping = base_mapper.get_task_mapping(sys);
-	
-		MappingEvaluator eval(sys);
-		Time initial_cost = eval.compute_cost(current_best_mapping);
+	Mapping const base_mapping = base_mapper.get_task_mapping(sys);
+	std::vector<Mapping> run_mappings(annealing_runs);
+	std::vector<Time> run_costs(annealing_runs);
+
+	pool.parallel_for(annealing_runs, [&](size_t run, size_t worker) {
+		MappingEvaluator const& eval = pool.get_evaluator(worker);
+		IncrementalEvaluator& inc_eval = *inc_evals[worker];
+		LowerBoundEvaluator& bound_eval = *bound_evals[worker];
+		Xoshiro256 rng = streams.stream(run);
+		Mapping& current_best_mapping = run_mappings[run];
+		current_best_mapping = base_mapping;
+
+		Time initial_cost = inc_eval.set_base(current_best_mapping);
+		bound_eval.set_base(current_best_mapping);
 		Time current_best_cost = initial_cost;
 
 		Temperature temperature = 1;
 		MappingView curr_mapping(&current_best_mapping);
 #ifndef NO_SA_LOG
 		int iteration = 0;
+		size_t pruned = 0;
 #endif
 		while (temperature > final_temperature) {
 			Time curr_cost = 0;
 			for (size_t i = 0; i < iterations_per_temperature; ++i) {
-				MappingView new_mapping = iterate(curr_mapping, sys);
+				MappingView new_mapping = iterate(curr_mapping, sys, eval.get_costs(), rng);
 				if (!eval.satisfies_capacity_constraint(new_mapping)) {
 					continue;
 				}
-				curr_cost = eval.compute_cost(new_mapping);
-				if (curr_cost < current_best_cost || accept(curr_cost - current_best_cost, initial_cost, temperature)) {
+				bool accepted;
+				Time const bound = bound_eval.compute_bound(new_mapping, new_mapping.get_mapped_tasks());
+				if (bound >= current_best_cost) {
+					// The move cannot improve, so the acceptance is drawn in any case. As accept is monotonic in the cost,
+					// a move rejected with its lower bound is also rejected with its cost and need not be simulated.
+					int const draw = static_cast<int>(random_index(rng, 1000));
+					if (!accept(bound - current_best_cost, initial_cost, temperature, draw)) {
+#ifndef NO_SA_LOG
+						++pruned;
+#endif
+						continue;
+					}
+					curr_cost = inc_eval.compute_cost(new_mapping, new_mapping.get_mapped_tasks());
+					accepted = accept(curr_cost - current_best_cost, initial_cost, temperature, draw);
+				}
+				else {
+					curr_cost = inc_eval.compute_cost(new_mapping, new_mapping.get_mapped_tasks());
+					accepted = curr_cost < current_best_cost || accept(curr_cost - current_best_cost, initial_cost, temperature, rng);
+				}
+				if (accepted) {
 					new_mapping.apply(curr_mapping);
+					inc_eval.commit(curr_mapping);
+					bound_eval.commit(curr_mapping);
 					if (curr_cost < current_best_cost) {
 						curr_mapping.apply(current_best_mapping);
 						curr_mapping.reset(&current_best_mapping);
@@ -46,31 +85,29 @@ Mapping SimulatedAnnealingMapper::get_task_mapping(System const& sys) const {
 				}
 			}
 #ifndef NO_SA_LOG
-			std::cout << "\rRun " << run << ", It " << std::setw(3) << ++iteration << " -- Cur: " << std::setw(8) << curr_cost << " Best: " << current_best_cost << " Total: " << best_cost << " Temp: " << std::setw(11) << temperature << " Final: " << final_temperature << std::flush;
+			std::cout << "\rRun " << run << ", It " << std::setw(3) << ++iteration << " -- Cur: " << std::setw(8) << curr_cost << " Best: " << current_best_cost << " Temp: " << std::setw(11) << temperature << " Final: " << final_temperature << " Pruned: " << pruned << std::flush;
 #endif
 			adjust_temperature(temperature);
 		}
 
-		if (current_best_cost < best_cost) {
-			best_cost = current_best_cost;
-			best_mapping = std::move(current_best_mapping);
-		}
-	}
+		run_costs[run] = current_best_cost;
+	});
 
-	return best_mapping;
+	size_t const best_run = std::min_element(run_costs.begin(), run_costs.end()) - run_costs.begin();
+	return std::move(run_mappings[best_run]);
 }
 
-MappingView SimulatedAnnealingMapper::iterate(Mapping& curr_mapping, System const& sys) const {
+MappingView SimulatedAnnealingMapper::iterate(Mapping& curr_mapping, System const& sys, CostTable const& costs, Xoshiro256& rng) const {
 	std::vector<Task*> const& tasks = sys.get_task_graph().get_tasks();
 	std::vector<Processor*> const& processors = sys.get_platform().get_processors();
 
-	Task* rand_task = tasks[rand() % tasks.size()];
+	Task* rand_task = tasks[random_index(rng, tasks.size())];
 
-	size_t proc_idx = rand() % processors.size();
+	size_t proc_idx = random_index(rng, processors.size());
 	Processor* rand_proc = processors[proc_idx];
 
 	if (rand_proc == curr_mapping.get_processor(rand_task)) {
-		size_t new_idx = rand() % (processors.size() - 1);
+		size_t new_idx = random_index(rng, processors.size() - 1);
 		if (new_idx >= proc_idx) {
 			++new_idx;
 		}
@@ -79,7 +116,7 @@ MappingView SimulatedAnnealingMapper::iterate(Mapping& curr_mapping, System cons
 
 	MappingView new_mapping(&curr_mapping);
 
-	if (sys.is_compatible(rand_task, rand_proc)) {
+	if (costs.is_compatible(rand_task, rand_proc)) {
 		new_mapping.map(rand_task, rand_proc);
 	}
 
@@ -87,12 +124,16 @@ MappingView SimulatedAnnealingMapper::iterate(Mapping& curr_mapping, System cons
 }
 
 
-bool SimulatedAnnealingMapper::accept(Time const& cost_diff, Time const& initial_cost, Temperature const& temperature) const {
+bool SimulatedAnnealingMapper::accept(Time const& cost_diff, Time const& initial_cost, Temperature const& temperature, Xoshiro256& rng) const {
+	return accept(cost_diff, initial_cost, temperature, static_cast<int>(random_index(rng, 1000)));
+}
+
+bool SimulatedAnnealingMapper::accept(Time const& cost_diff, Time const& initial_cost, Temperature const& temperature, int draw) const {
 	double const accept_threshold = std::exp(-2 * cost_diff / (temperature * initial_cost));
-	return rand() % 1000 < 1000 * accept_threshold;
+	return draw < 1000 * accept_threshold;
 }
 
-Temperature SimulatedAnnealingMapper::get_normalized_final_temperature(System const& sys) const {
+Temperature SimulatedAnnealingMapper::get_normalized_final_temperature(System const& sys, CostTable const& costs) const {
 	const int safety_margin_factor = 2;
 	
 	Time total_min_cost = 0;
@@ -101,13 +142,13 @@ Temperature SimulatedAnnealingMapper::get_normalized_final_temperature(System co
 	Time min_cost = std::numeric_limits<Time>::max();
 	Time max_cost = 0;
 
-	std::vector<Processor*> processors = sys.get_platform().get_processors();
+	std::vector<Processor*> const& processors = sys.get_platform().get_processors();
 	for (Task* task : sys.get_task_graph().get_tasks()) {
 		Time curr_min_cost = std::numeric_limits<Time>::max();
 		Time curr_max_cost = 0;
 		for (Processor* proc : processors) {
-			if (sys.is_compatible(task, proc)) {
-				Time cost = sys.computation_time_ms(task, proc);
+			if (costs.is_compatible(task, proc)) {
+				Time cost = costs.computation_time(task, proc);
 				if (cost <= 0 || cost >= std::numeric_limits<Time>::max()) {
 					continue;
 				}
@@ -1,15 +1,22 @@
 #pragma once
 
 #include "Mapper.h"
+#include "Random.h"
 
 typedef double Temperature;
 
+class CostTable;
+
 class SimulatedAnnealingMapper : public Mapper {
+	RandomStreams const streams;
 public:
+	SimulatedAnnealingMapper(RandomStreams const& streams = RandomStreams()) : streams(streams) {}
 	Mapping get_task_mapping(System const&) const;
 protected:
-	virtual MappingView iterate(Mapping& curr_mapping, System const& sys) const;
-	virtual bool accept(Time const& cost_diff, Time const& initial_cost, Temperature const& temperature) const;
-	virtual Temperature get_normalized_final_temperature(System const& sys) const;
+	virtual MappingView iterate(Mapping& curr_mapping, System const& sys, CostTable const& costs, Xoshiro256& rng) const;
+	virtual bool accept(Time const& cost_diff, Time const& initial_cost, Temperature const& temperature, Xoshiro256& rng) const;
+	// Same as accept, with the random number in [0, 1000) drawn by the caller
+	bool accept(Time const& cost_diff, Time const& initial_cost, Temperature const& temperature, int draw) const;
+	virtual Temperature get_normalized_final_temperature(System const& sys, CostTable const& costs) const;
 	virtual void adjust_temperature(Temperature& temperature) const;
 };
\ No newline at end of file
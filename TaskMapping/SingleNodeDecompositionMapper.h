@@ -4,7 +4,7 @@
 
 template <class Policies> class SingleNodeDecompositionMapper : public DecompositionMapper<Policies> {
 protected:
-	Decomposition create_decomposition(TaskGraph const& task_graph) const {
+	Decomposition create_decomposition(FrozenTaskGraph const& task_graph) const {
 		Decomposition decomposition;
 
 		for (Task* task : task_graph.get_tasks()) {
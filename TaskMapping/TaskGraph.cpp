@@ -1,6 +1,8 @@
 #include "TaskGraph.h"
+#include "FrozenTaskGraph.h"
 #include <algorithm>
 #include <numeric>
+#include <type_traits>
 
 DataSize SUMMED_PROPAGATION(std::vector<DataSize> const& data_in) {
 	return std::reduce(std::begin(data_in), std::end(data_in));
@@ -29,48 +31,189 @@ DataSize DATA_SNK(std::vector<DataSize> const&) {
 	return 0;
 }
 
-void Task::compute_size() const {
-	std::vector<DataSize> input_sizes;
-	input_size = 0;
-	for (Edge* edge : edges_in) {
-		DataSize const& output_size = edge->get_src()->get_output_size();
-		input_size += output_size;
-		input_sizes.push_back(output_size);
+SizeFunction::SizeFunction(FuncPtr func) : rule(SizeRule::CUSTOM), custom(func) {
+	if (func == &SUMMED_PROPAGATION) {
+		rule = SizeRule::SUMMED;
 	}
-	output_size = size_func(input_sizes);
+	else if (func == &MAX_PROPAGATION) {
+		rule = SizeRule::MAX;
+	}
+	else if (func == &AVERAGE_PROPAGATION) {
+		rule = SizeRule::AVERAGE;
+	}
+	else if (func == &DATA_SRC) {
+		rule = SizeRule::DATA_SRC;
+	}
+	else if (func == &DATA_SNK) {
+		rule = SizeRule::DATA_SNK;
+	}
+}
+
+// The attributes are read by evaluators through the frozen graph, which a change would destroy
+void Task::set_size_func(SizeFuncPtr const& func) {
+	assert(!graph->frozen && "Task attributes must not change after TaskGraph::freeze()");
+	size_func = func;
+	graph->invalidate(true);
+}
 
-	dirty = false;
+void Task::set_area(Area const& area) {
+	assert(!graph->frozen && "Task attributes must not change after TaskGraph::freeze()");
+	this->area = area;
+	graph->invalidate(false);
 }
 
 void Task::add_outgoing_edge(Edge* edge_out) {
+	Task* const snk = edge_out->get_snk();
+	edge_out->out_pos = edges_out.size();
+	edge_out->in_pos = snk->edges_in.size();
 	edges_out.push_back(edge_out);
-	edge_out->get_snk()->edges_in.push_back(edge_out);
-
-	dirty = true;
-	edge_out->get_snk()->dirty = true;
+	snk->edges_in.push_back(edge_out);
 }
 
 void Task::delete_outgoing_edge(Edge* edge_out) {
-	auto out_it = std::find(edges_out.begin(), edges_out.end(), edge_out);
-	assert(out_it != edges_out.end());
-	edges_out.erase(out_it);
+	Task* const snk = edge_out->get_snk();
+	assert(edges_out[edge_out->out_pos] == edge_out && snk->edges_in[edge_out->in_pos] == edge_out);
 
-	std::vector<Edge*>& succ_edges_in = edge_out->get_snk()->edges_in;
-	auto in_it = std::find(succ_edges_in.begin(), succ_edges_in.end(), edge_out);
-	assert(in_it != succ_edges_in.end());
-	succ_edges_in.erase(in_it);
+	Edge* const last_out = edges_out.back();
+	edges_out[edge_out->out_pos] = last_out;
+	last_out->out_pos = edge_out->out_pos;
+	edges_out.pop_back();
 
-	dirty = true;
-	edge_out->get_snk()->dirty = true;
+	Edge* const last_in = snk->edges_in.back();
+	snk->edges_in[edge_out->in_pos] = last_in;
+	last_in->in_pos = edge_out->in_pos;
+	snk->edges_in.pop_back();
 }
 
+TaskGraph::TaskGraph() = default;
+
 TaskGraph::~TaskGraph() {
 	clear();
 }
 
+TaskGraph::TaskGraph(TaskGraph&& other) noexcept :
+	arena(std::move(other.arena)),
+	src_nodes(std::move(other.src_nodes)),
+	snk_nodes(std::move(other.snk_nodes)),
+	tasks(std::move(other.tasks)),
+	edges(std::move(other.edges)),
+	frozen(std::move(other.frozen)),
+	input_sizes(std::move(other.input_sizes)),
+	output_sizes(std::move(other.output_sizes)),
+	sizes_dirty(other.sizes_dirty)
+{
+	for (Task* task : tasks) {
+		task->graph = this;
+	}
+}
+
+void TaskGraph::operator=(TaskGraph&& other) noexcept {
+	clear();
+	arena = std::move(other.arena);
+	src_nodes = std::move(other.src_nodes);
+	snk_nodes = std::move(other.snk_nodes);
+	tasks = std::move(other.tasks);
+	edges = std::move(other.edges);
+	frozen = std::move(other.frozen);
+	input_sizes = std::move(other.input_sizes);
+	output_sizes = std::move(other.output_sizes);
+	sizes_dirty = other.sizes_dirty;
+	for (Task* task : tasks) {
+		task->graph = this;
+	}
+}
+
+void TaskGraph::clear() {
+	// Edges are trivially destructible and the adjacency lists live in the arena,
+	// so only the size functions of the tasks need to be destroyed before the arena is released
+	static_assert(std::is_trivially_destructible_v<Edge>);
+	for (Task* task_ptr : tasks) {
+		task_ptr->~Task();
+	}
+
+	tasks.clear();
+	edges.clear();
+	src_nodes.clear();
+	snk_nodes.clear();
+	frozen.reset();
+	input_sizes.clear();
+	output_sizes.clear();
+	sizes_dirty = true;
+	arena.reset();
+}
+
+std::pmr::memory_resource* TaskGraph::get_arena() {
+	if (!arena) {
+		arena = std::make_unique<std::pmr::monotonic_buffer_resource>();
+	}
+	return arena.get();
+}
+
+void TaskGraph::invalidate(bool sizes_changed) {
+	frozen.reset();
+	sizes_dirty = sizes_dirty || sizes_changed;
+}
+
+void TaskGraph::propagate_sizes() const {
+	size_t const nbr_tasks = tasks.size();
+	input_sizes.assign(nbr_tasks, 0);
+	output_sizes.assign(nbr_tasks, 0);
+
+	// Kahn's algorithm, order doubles as the queue
+	std::vector<size_t> missing_inputs(nbr_tasks);
+	std::vector<TaskId> order;
+	order.reserve(nbr_tasks);
+	for (Task* task : tasks) {
+		missing_inputs[task->id] = task->edges_in.size();
+		if (task->edges_in.empty()) {
+			order.push_back(task->id);
+		}
+	}
+
+	std::vector<DataSize> data_in; // Only filled for custom size functions
+	for (size_t head = 0; head < order.size(); ++head) {
+		Task const* task = tasks[order[head]];
+		bool const custom = task->size_func.get_rule() == SizeRule::CUSTOM;
+
+		DataSize sum = 0;
+		DataSize max = 0;
+		data_in.clear();
+		for (Edge* edge : task->edges_in) {
+			DataSize const size = output_sizes[edge->src->id];
+			sum += size;
+			max = std::max(max, size);
+			if (custom) {
+				data_in.push_back(size);
+			}
+		}
+		input_sizes[task->id] = sum;
+		output_sizes[task->id] = task->size_func.compute(sum, max, task->edges_in.size(), data_in);
+
+		for (Edge* edge : task->edges_out) {
+			if (--missing_inputs[edge->snk->id] == 0) {
+				order.push_back(edge->snk->id);
+			}
+		}
+	}
+	assert(order.size() == nbr_tasks); // Graph has to be acyclic
+
+	sizes_dirty = false;
+}
+
+FrozenTaskGraph const& TaskGraph::freeze() const {
+	if (!frozen) {
+		frozen = std::make_unique<FrozenTaskGraph>(*this);
+	}
+	return *frozen;
+}
+
 Task* TaskGraph::add_node(ScaleFactor const& complexity, Percent const& parallelizability, ScaleFactor const& streamability, Task::SizeFuncPtr const& size_func, std::vector<Task*> predecessors, std::vector<Task*> successors) {
-	Task* new_task = new Task(complexity, parallelizability, streamability, size_func);
+	std::pmr::memory_resource* const resource = get_arena();
+	Task* new_task = new (resource->allocate(sizeof(Task), alignof(Task))) Task(complexity, parallelizability, streamability, size_func, resource);
+	new_task->id = static_cast<TaskId>(tasks.size());
+	new_task->graph = this;
 	tasks.push_back(new_task);
+	invalidate(true);
 
 	if (predecessors.size() == 0) {
 		src_nodes.insert(new_task);
@@ -96,8 +239,10 @@ void TaskGraph::add_edge(Edge const& edge) {
 }
 
 void TaskGraph::add_edge(Task* src, Task* snk) {
-	Edge* new_edge = new Edge(src, snk);
+	Edge* new_edge = new (get_arena()->allocate(sizeof(Edge), alignof(Edge))) Edge(src, snk);
+	new_edge->id = static_cast<EdgeId>(edges.size());
 	edges.push_back(new_edge);
+	invalidate(true);
 
 	snk_nodes.erase(src);
 	src_nodes.erase(snk);
@@ -106,22 +251,30 @@ void TaskGraph::add_edge(Task* src, Task* snk) {
 }
 
 void TaskGraph::delete_edge(Edge* edge) {
-	delete_edge(edge->get_src(), edge->get_snk());
-}
-
-void TaskGraph::delete_edge(Task* csrc, Task* csnk) {
-	auto it = std::find_if(edges.begin(), edges.end(), [csrc, csnk](Edge* edge) { return edge->get_src() == csrc && edge->get_snk() == csnk; });
-	if (it != edges.end()) {
-		Task* const src = (*it)->get_src();
-		Task* const snk = (*it)->get_snk();
-		
-		src->delete_outgoing_edge(*it);
-		if (src->get_edges_out().size() == 0) {
-			snk_nodes.insert(src);
-		}
-		if (snk->get_edges_in().size() == 0) {
-			src_nodes.insert(snk);
-		}
-		edges.erase(it);
+	assert(edge->id < edges.size() && edges[edge->id] == edge);
+	Task* const src = edge->get_src();
+	Task* const snk = edge->get_snk();
+
+	src->delete_outgoing_edge(edge);
+	if (src->get_edges_out().size() == 0) {
+		snk_nodes.insert(src);
+	}
+	if (snk->get_edges_in().size() == 0) {
+		src_nodes.insert(snk);
 	}
+
+	// Memory of the edge is reclaimed with the arena
+	Edge* const last = edges.back();
+	edges[edge->id] = last;
+	last->id = edge->id;
+	edges.pop_back();
+	invalidate(true);
 }
+
+void TaskGraph::delete_edge(Task* src, Task* snk) {
+	std::span<Edge* const> const edges_out = src->get_edges_out();
+	auto it = std::find_if(edges_out.begin(), edges_out.end(), [snk](Edge* edge) { return edge->get_snk() == snk; });
+	if (it != edges_out.end()) {
+		delete_edge(*it);
+	}
+}
\ No newline at end of file
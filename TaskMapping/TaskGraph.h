@@ -8,19 +8,32 @@
 #include <cassert>
 #include <string>
 #include <functional>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
 
 class Task;
 class TaskGraph;
+class TaskGraphBuilder;
+class FrozenTaskGraph;
 
 class Edge {
+	friend class TaskGraph;
+	friend class TaskGraphBuilder;
+	friend class Task;
 public:
 	Edge(Task* src, Task* snk) : src(src), snk(snk) {}
 
 	Task* get_src() const { return src;	};
 	Task* get_snk() const { return snk; };
+	EdgeId get_id() const { return id; }
 private:
 	Task* src;
 	Task* snk;
+	EdgeId id = 0; // Position in TaskGraph::get_edges()
+	size_t out_pos = 0; // Position in src->get_edges_out()
+	size_t in_pos = 0; // Position in snk->get_edges_in()
 };
 
 DataSize SUMMED_PROPAGATION(std::vector<DataSize> const& data_in);
@@ -29,17 +42,58 @@ DataSize AVERAGE_PROPAGATION(std::vector<DataSize> const& data_in);
 DataSize DATA_SRC(std::vector<DataSize> const&);
 DataSize DATA_SNK(std::vector<DataSize> const&);
 
+enum class SizeRule { SUMMED, MAX, AVERAGE, DATA_SRC, DATA_SNK, CONSTANT, CUSTOM };
+
+// Computes the output size of a task from the output sizes of its predecessors.
+// The propagation functions above and constant sizes are dispatched by rule, only CUSTOM goes through the std::function.
+class SizeFunction {
+public:
+	typedef DataSize (*FuncPtr) (std::vector<DataSize> const&);
+
+	SizeFunction() : rule(SizeRule::SUMMED) {}
+	SizeFunction(FuncPtr func);
+
+	template <class Func, class = std::enable_if_t<std::is_invocable_r_v<DataSize, Func, std::vector<DataSize> const&> && !std::is_same_v<std::decay_t<Func>, SizeFunction>>>
+	SizeFunction(Func&& func) : rule(SizeRule::CUSTOM), custom(std::forward<Func>(func)) {}
+
+	static SizeFunction constant(DataSize size) { SizeFunction func; func.rule = SizeRule::CONSTANT; func.constant_size = size; return func; }
+
+	SizeRule get_rule() const { return rule; }
+
+	// sum, max and count describe the output sizes of the predecessors, data_in is only required for CUSTOM
+	DataSize compute(DataSize sum, DataSize max, size_t count, std::vector<DataSize> const& data_in) const {
+		switch (rule) {
+		case SizeRule::SUMMED: return sum;
+		case SizeRule::MAX: return max;
+		case SizeRule::AVERAGE: return count == 0 ? 0 : sum / static_cast<DataSize>(count);
+		case SizeRule::DATA_SRC: return DATA_SRC(data_in);
+		case SizeRule::DATA_SNK: return 0;
+		case SizeRule::CONSTANT: return constant_size;
+		case SizeRule::CUSTOM: return custom(data_in);
+		}
+		return 0;
+	}
+
+private:
+	SizeRule rule;
+	DataSize constant_size = 0;
+	std::function<DataSize (std::vector<DataSize> const&)> custom;
+};
+
 class Task {
 	friend class TaskGraph;
+	friend class TaskGraphBuilder;
 public:
     //typedef DataSize (*SizeFuncPtr) (std::vector<DataSize> const&);
-    typedef std::function<DataSize (std::vector<DataSize> const&)> SizeFuncPtr;
+    typedef SizeFunction SizeFuncPtr;
 	//std::vector<Task*> const& get_predecessors() const { return predecessors; };
 	//std::vector<Task*> const& get_successors() const { return successors; };	
-	std::vector<Edge*> const& get_edges_in() const { return edges_in; };
-	std::vector<Edge*> const& get_edges_out() const { return edges_out; };
+	std::span<Edge* const> get_edges_in() const { return edges_in; };
+	std::span<Edge* const> get_edges_out() const { return edges_out; };
 
-	Task(ScaleFactor const& complexity, Percent const& parallelizability, ScaleFactor const& streamability, SizeFuncPtr const& size_func) :
+	Task(ScaleFactor const& complexity, Percent const& parallelizability, ScaleFactor const& streamability, SizeFuncPtr const& size_func, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) :
+		edges_in(resource),
+		edges_out(resource),
 		complexity(complexity), 
 		parallelizability(parallelizability), 
 		streamability(streamability),
@@ -49,23 +103,14 @@ public:
         GUID = generate_GUID();
     }
 
-    void set_size_func(SizeFuncPtr const& func) {size_func = func; dirty = true;}
-	void set_area(Area const& area) {
-		this->area = area;
-	}
+	// Only before the graph is frozen, see TaskGraph::freeze()
+    void set_size_func(SizeFuncPtr const& func);
+	void set_area(Area const& area);
 
-	DataSize const& get_input_size() const { 
-		if (dirty) {
-			compute_size();
-		}
-		return input_size; 
-	}
-	DataSize const& get_output_size() const {
-		if (dirty) {
-			compute_size();
-		}
-		return output_size; 
-	}
+	// Sizes are propagated through the whole graph at once, see TaskGraph::get_input_sizes()
+	DataSize const& get_input_size() const;
+	DataSize const& get_output_size() const;
+	SizeFuncPtr const& get_size_func() const { return size_func; }
 
 	Percent const& get_parallelizability() const { return parallelizability; }
 	ScaleFactor const& get_complexity() const { return complexity; }
@@ -78,6 +123,7 @@ public:
 	}
 
 	bool is_streamable() const { return streamability > 1; }
+	TaskId get_id() const { return id; }
 
 	std::vector<Task*> compute_successors() const {
 		std::vector<Task*> successors;
@@ -90,17 +136,14 @@ public:
 	}
 
 private:
-	void compute_size() const;
 	void add_outgoing_edge(Edge* edge_out);
 	void delete_outgoing_edge(Edge* edge_out);
 
-	std::vector<Edge*> edges_in;
-	std::vector<Edge*> edges_out;
-
-	mutable DataSize input_size = -1;
-	mutable DataSize output_size = -1;
+	// Allocated from the arena of the owning TaskGraph
+	std::pmr::vector<Edge*> edges_in;
+	std::pmr::vector<Edge*> edges_out;
 
-	mutable bool dirty = true;
+	TaskGraph* graph = nullptr; // Owning graph
 
     ScaleFactor complexity;
 	Percent parallelizability;
@@ -110,27 +153,17 @@ private:
 	SizeFuncPtr size_func;
 
     unsigned GUID;
+	TaskId id = 0; // Position in TaskGraph::get_tasks()
 };
 
 class TaskGraph {
+	friend class TaskGraphBuilder;
 public:
 	~TaskGraph();
-	TaskGraph() = default;
-
-	TaskGraph(TaskGraph&& other) noexcept :
-		src_nodes(std::move(other.src_nodes)),
-		snk_nodes(std::move(other.snk_nodes)),
-		tasks(std::move(other.tasks)),
-		edges(std::move(other.edges))
-	{}
-
-	void operator=(TaskGraph&& other) noexcept {
-		clear();
-		src_nodes = std::move(other.src_nodes);
-		snk_nodes = std::move(other.snk_nodes);
-		tasks = std::move(other.tasks);
-		edges = std::move(other.edges);
-	}
+	TaskGraph();
+
+	TaskGraph(TaskGraph&& other) noexcept;
+	void operator=(TaskGraph&& other) noexcept;
 
 	std::unordered_set<Task*> const& get_src() const { return src_nodes; };
 	std::unordered_set<Task*> const& get_snk() const { return snk_nodes; };
@@ -138,31 +171,45 @@ public:
 	Task* add_node(ScaleFactor const& complexity = 1, Percent const& parallelizability = 0, ScaleFactor const& streamability = 1, Task::SizeFuncPtr const& size_func = &SUMMED_PROPAGATION, std::vector<Task*> predecessors = {}, std::vector<Task*> successors = {});
 	void add_edge(Edge const& edge);
 	void add_edge(Task* src, Task* snk);
+	// Edges are removed by swapping the last edge into their place, so the ids and adjacency positions of other edges may change
 	void delete_edge(Edge* edge);
 	void delete_edge(Task* src, Task* snk);
 
 	std::vector<Task*> const& get_tasks() const { return tasks; };
 	std::vector<Edge*> const& get_edges() const { return edges; };
 
+	// Index-based snapshot of the graph, rebuilt lazily after the graph has been modified. Evaluators, cost tables and
+	// simulators keep references to it, so the graph must not change once they exist. Task::set_area and
+	// Task::set_size_func assert that the graph has not been frozen yet.
+	FrozenTaskGraph const& freeze() const;
+
+	// Input and output size of every task indexed by task id, recomputed in one topological pass after the graph has been modified
+	std::vector<DataSize> const& get_input_sizes() const { if (sizes_dirty) propagate_sizes(); return input_sizes; }
+	std::vector<DataSize> const& get_output_sizes() const { if (sizes_dirty) propagate_sizes(); return output_sizes; }
+
 private:
-	void clear() {
-		for (Task* task_ptr : tasks) {
-			delete task_ptr;
-		}
+	friend class Task;
 
-		for (Edge* edge_ptr : edges) {
-			delete edge_ptr;
-		}
+	void clear();
+	void propagate_sizes() const;
+	void invalidate(bool sizes_changed);
+	std::pmr::memory_resource* get_arena();
 
-		tasks.clear();
-		edges.clear();
-		src_nodes.clear();
-		snk_nodes.clear();
-	}
+	// Owns all tasks, edges and adjacency lists, which are released at once when the graph is destroyed
+	std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
 
 	std::unordered_set<Task*> src_nodes;
 	std::unordered_set<Task*> snk_nodes;
 
 	std::vector<Task*> tasks;
 	std::vector<Edge*> edges;
-};
\ No newline at end of file
+
+	mutable std::unique_ptr<FrozenTaskGraph> frozen;
+
+	mutable std::vector<DataSize> input_sizes;
+	mutable std::vector<DataSize> output_sizes;
+	mutable bool sizes_dirty = true;
+};
+
+inline DataSize const& Task::get_input_size() const { return graph->get_input_sizes()[id]; }
+inline DataSize const& Task::get_output_size() const { return graph->get_output_sizes()[id]; }
\ No newline at end of file
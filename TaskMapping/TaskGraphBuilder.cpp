@@ -0,0 +1,60 @@
+#include "TaskGraphBuilder.h"
+
+#include <algorithm>
+
+TaskGraph TaskGraphBuilder::finalize() {
+	size_t const nbr_tasks = nodes.size();
+	size_t const nbr_edges = edges.size();
+
+	std::vector<size_t> in_degree(nbr_tasks, 0);
+	std::vector<size_t> out_degree(nbr_tasks, 0);
+	for (EdgeProperties const& edge : edges) {
+		++out_degree[edge.first];
+		++in_degree[edge.second];
+	}
+
+	// One block for everything, with some slack for alignment
+	size_t const arena_size = nbr_tasks * (sizeof(Task) + alignof(Task)) + nbr_edges * (sizeof(Edge) + 2 * sizeof(Edge*)) + 2 * nbr_tasks * alignof(Edge*);
+
+	TaskGraph task_graph;
+	task_graph.arena = std::make_unique<std::pmr::monotonic_buffer_resource>(std::max(arena_size, size_t(1)));
+	std::pmr::memory_resource* const resource = task_graph.arena.get();
+
+	task_graph.tasks.reserve(nbr_tasks);
+	for (size_t i = 0; i < nbr_tasks; ++i) {
+		NodeProperties& node = nodes[i];
+		Task* task = new (resource->allocate(sizeof(Task), alignof(Task))) Task(node.complexity, node.parallelizability, node.streamability, std::move(node.size_func), resource);
+		task->id = static_cast<TaskId>(i);
+		task->graph = &task_graph;
+		task->edges_in.reserve(in_degree[i]);
+		task->edges_out.reserve(out_degree[i]);
+		task_graph.tasks.push_back(task);
+	}
+
+	Edge* const edge_block = static_cast<Edge*>(resource->allocate(nbr_edges * sizeof(Edge), alignof(Edge)));
+	task_graph.edges.reserve(nbr_edges);
+	for (size_t i = 0; i < nbr_edges; ++i) {
+		Task* const src = task_graph.tasks[edges[i].first];
+		Task* const snk = task_graph.tasks[edges[i].second];
+		Edge* edge = new (edge_block + i) Edge(src, snk);
+		edge->id = static_cast<EdgeId>(i);
+		edge->out_pos = src->edges_out.size();
+		edge->in_pos = snk->edges_in.size();
+		src->edges_out.push_back(edge);
+		snk->edges_in.push_back(edge);
+		task_graph.edges.push_back(edge);
+	}
+
+	for (Task* task : task_graph.tasks) {
+		if (task->edges_in.empty()) {
+			task_graph.src_nodes.insert(task);
+		}
+		if (task->edges_out.empty()) {
+			task_graph.snk_nodes.insert(task);
+		}
+	}
+
+	nodes.clear();
+	edges.clear();
+	return task_graph;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "TaskGraph.h"
+
+#include <vector>
+#include <span>
+#include <utility>
+
+// Collects nodes and edges in bulk and creates the TaskGraph in a single finalize step.
+// All tasks, edges and adjacency lists are allocated from one arena with exactly reserved sizes,
+// sources and sinks are computed once.
+class TaskGraphBuilder {
+public:
+	struct NodeProperties {
+		ScaleFactor complexity = 1;
+		Percent parallelizability = 0;
+		ScaleFactor streamability = 1;
+		Task::SizeFuncPtr size_func = &SUMMED_PROPAGATION;
+	};
+
+	typedef std::pair<TaskId, TaskId> EdgeProperties; // src, snk
+
+	TaskGraphBuilder(size_t expected_nodes = 0, size_t expected_edges = 0) {
+		nodes.reserve(expected_nodes);
+		edges.reserve(expected_edges);
+	}
+
+	TaskId add_node(ScaleFactor const& complexity = 1, Percent const& parallelizability = 0, ScaleFactor const& streamability = 1, Task::SizeFuncPtr const& size_func = &SUMMED_PROPAGATION) {
+		nodes.push_back({ complexity, parallelizability, streamability, size_func });
+		return static_cast<TaskId>(nodes.size() - 1);
+	}
+
+	// Returns the id of the first added node, the others follow consecutively
+	TaskId add_nodes(std::span<NodeProperties const> batch) {
+		TaskId const first = static_cast<TaskId>(nodes.size());
+		nodes.insert(nodes.end(), batch.begin(), batch.end());
+		return first;
+	}
+
+	void add_edge(TaskId src, TaskId snk) {
+		assert(src < nodes.size() && snk < nodes.size());
+		edges.emplace_back(src, snk);
+	}
+
+	void add_edges(std::span<EdgeProperties const> batch) {
+		edges.insert(edges.end(), batch.begin(), batch.end());
+	}
+
+	size_t nbr_nodes() const { return nodes.size(); }
+	size_t nbr_edges() const { return edges.size(); }
+
+	// Task and edge ids equal the order in which they were added. The builder is empty afterwards.
+	TaskGraph finalize();
+
+private:
+	std::vector<NodeProperties> nodes;
+	std::vector<EdgeProperties> edges;
+};
\ No newline at end of file
@@ -1,13 +1,15 @@
 #pragma once
 
 #include "TaskGraph.h"
+#include "TaskGraphBuilder.h"
 #include "TopologicalSorting.h"
+#include "Random.h"
 
 #include <unordered_map>
 #include <random>
 
 class TaskPropertyProducer {
-    std::default_random_engine gen;
+    Xoshiro256& rng;
     std::lognormal_distribution<double> lognormal;
 
 public:
@@ -18,64 +20,66 @@ public:
         ScaleFactor streamability;
     };
 
-    TaskPropertyProducer() {
-        gen = std::default_random_engine((rand() % 1000));
+    TaskPropertyProducer(Xoshiro256& rng) : rng(rng) {
         //lognormal = std::lognormal_distribution<double>(3.0, 0.5);
         lognormal = std::lognormal_distribution<double>(2.0, 0.5);
     }
 
     TaskProperties get_properties() {
-        return { std::ceil(lognormal(gen)), (Percent)((rand() % 2 == 0) ? 100 : rand() % 101), std::ceil(lognormal(gen)) };
+        return { std::ceil(lognormal(rng)), (Percent)((random_index(rng, 2) == 0) ? 100 : random_index(rng, 101)), std::ceil(lognormal(rng)) };
     }
 };
 
-TaskGraph generate_random_series_parallel_graph(size_t size = 10, DataSize const& data_in_mb = 1) {
+// The generators draw everything from rng, so a graph is determined by the state of rng, e.g. a stream of RandomStreams
+TaskGraph generate_random_series_parallel_graph(Xoshiro256& rng, size_t size = 10, DataSize const& data_in_mb = 1) {
 
-	TaskGraph g;
+	TaskGraphBuilder builder(size, 2 * size);
 
-    Task* src = g.add_node(1, 100, 1, [data_in_mb](std::vector<DataSize> const&) {return data_in_mb;});
-	/*Task* snk =*/ g.add_node(1, 100, 1, &DATA_SNK, { src });
+    TaskId src = builder.add_node(1, 100, 1, SizeFunction::constant(data_in_mb));
+	TaskId snk = builder.add_node(1, 100, 1, &DATA_SNK);
 
-	std::unordered_map<Edge*, int> duplicate_edges;
-    TaskPropertyProducer tpprod;
+	// Edge list with the number of pending parallel duplicates per edge
+	std::vector<TaskGraphBuilder::EdgeProperties> edges = { { src, snk } };
+	std::vector<int> duplicate_edges = { 0 };
+    TaskPropertyProducer tpprod(rng);
 
 	for (size_t i = 0; i < size-2; ++i) {
-		std::vector<Edge*> const& edges = g.get_edges();
-
-		while (rand() % 3 < 2) {
-		//while (rand() % 2 == 0) {
+		while (random_index(rng, 3) < 2) {
+		//while (random_index(rng, 2) == 0) {
 			// Parallel operation
-			Edge* rand_edge = edges[rand() % edges.size()];
-
-			if (duplicate_edges.contains(rand_edge)) {
-				++duplicate_edges[rand_edge];
-			}
-			else {
-				duplicate_edges[rand_edge] = 1;
-			}
+			++duplicate_edges[random_index(rng, edges.size())];
 		}
 
 		// Series operation
-		Edge* rand_edge = edges[rand() % edges.size()];
+		size_t const rand_edge = random_index(rng, edges.size());
+		TaskGraphBuilder::EdgeProperties const split_edge = edges[rand_edge];
 
         auto properties = tpprod.get_properties();
-		/*Task* new_task =*/ g.add_node(properties.task_complexity, properties.parallelizability, properties.streamability, &MAX_PROPAGATION, { rand_edge->get_src() }, { rand_edge->get_snk() });
-        //new_task->set_area(properties.streamability * (rand() % 4 + 1));
+		TaskId new_task = builder.add_node(properties.task_complexity, properties.parallelizability, properties.streamability, &MAX_PROPAGATION);
+		edges.push_back({ split_edge.first, new_task });
+		duplicate_edges.push_back(0);
+		edges.push_back({ new_task, split_edge.second });
+		duplicate_edges.push_back(0);
 
-		if (duplicate_edges.contains(rand_edge) && duplicate_edges.at(rand_edge) > 0) {
+		if (duplicate_edges[rand_edge] > 0) {
 			--duplicate_edges[rand_edge];
 		}
 		else {
-			g.delete_edge(rand_edge);
+			// Swap and pop, the order of the edge list is irrelevant for the random selection
+			edges[rand_edge] = edges.back();
+			edges.pop_back();
+			duplicate_edges[rand_edge] = duplicate_edges.back();
+			duplicate_edges.pop_back();
 		}
 	}
 
-	return g;
+	builder.add_edges(edges);
+	return builder.finalize();
 }
 
-TaskGraph generate_random_almost_series_parallel_graph(size_t size = 10, DataSize const& data_in_mb = 1, size_t loose_edges = 5) {
-    TaskGraph g = generate_random_series_parallel_graph(size, data_in_mb);
-    RandomSorting topsort(g, false);
+TaskGraph generate_random_almost_series_parallel_graph(Xoshiro256& rng, size_t size = 10, DataSize const& data_in_mb = 1, size_t loose_edges = 5) {
+    TaskGraph g = generate_random_series_parallel_graph(rng, size, data_in_mb);
+    RandomSorting topsort(g.freeze(), rng, false);
     std::vector<GraphElement> const& sorted_elements = topsort.get_sorted_elements();
 
     size_t timeout = loose_edges * 10;
@@ -92,8 +96,8 @@ TaskGraph generate_random_almost_series_parallel_graph(size_t size = 10, DataSiz
                 // Stop execution if no new edges to be inserted can be found
                 return g;
             }
-            idx1 = rand() % sorted_elements.size();
-            idx2 = rand() % sorted_elements.size();
+            idx1 = random_index(rng, sorted_elements.size());
+            idx2 = random_index(rng, sorted_elements.size());
 
             if (idx1 == idx2) {
                 continue;
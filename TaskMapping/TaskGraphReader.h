@@ -1,6 +1,7 @@
 #pragma once
 
 #include "TaskGraph.h"
+#include "TaskGraphBuilder.h"
 #include "TaskGraphGenerator.h"
 #define BOOST_JSON_NO_LIB
 #define BOOST_CONTAINER_NO_LIB
@@ -9,13 +10,12 @@
 #include <fstream>
 
 TaskGraph build_from_json(std::string filename) {
-    TaskGraph task_graph;
     TaskPropertyProducer tpprod;
 
     std::ifstream ifs(filename);
     if (!ifs.good()) {
         std::cerr << "File not found " << filename << std::endl;
-        return task_graph;
+        return TaskGraph();
     }
 
     std::string input(std::istreambuf_iterator<char>(ifs), {});
@@ -37,7 +37,9 @@ TaskGraph build_from_json(std::string filename) {
     boost::json::value const& tasks = parsed_data.at("workflow").at("tasks");
     assert(tasks.is_array());
 
-    std::unordered_map<std::string, Task*> task_map;
+    TaskGraphBuilder builder(tasks.get_array().size());
+    std::unordered_map<std::string, TaskId> task_map;
+    task_map.reserve(tasks.get_array().size());
     for (boost::json::value const& task : tasks.get_array()) {
         auto properties = tpprod.get_properties();
 
@@ -57,7 +59,7 @@ TaskGraph build_from_json(std::string filename) {
         input_size_B = std::max(input_size_B, (DataSize)1);
 
         ScaleFactor const complexity = (runtime_s > 0 && avgCPU > 0 && CPUSpeed_MBps > 0) ? runtime_s / ((double)input_size_B / 1024. / 1024. / (CPUSpeed_MBps * avgCPU / 100.)) : 1;
-        Task* new_task = task_graph.add_node(complexity, properties.parallelizability, properties.streamability, [output_size_B](std::vector<DataSize> const&) {return std::max(output_size_B / 1024 / 1024, (DataSize)1);});
+        TaskId new_task = builder.add_node(complexity, properties.parallelizability, properties.streamability, SizeFunction::constant(std::max(output_size_B / 1024 / 1024, (DataSize)1)));
         //new_task->set_area(20); // Constant area requirement for every task;
         task_map[std::string(task.at("name").get_string())] = new_task;
     }
@@ -68,20 +70,22 @@ TaskGraph build_from_json(std::string filename) {
         use_parents = true;
     }
     for (boost::json::value const& task : tasks.get_array()) {
-        Task* curr_task = task_map.at(std::string(task.at("name").get_string()));
+        TaskId curr_task = task_map.at(std::string(task.at("name").get_string()));
 
         if (use_parents) {
             for (boost::json::value const& parent : task.at("parents").get_array()) {
-                task_graph.add_edge(task_map.at(std::string(parent.get_string())), curr_task);
+                builder.add_edge(task_map.at(std::string(parent.get_string())), curr_task);
             }
         }
         else {
             for (boost::json::value const& child : task.at("children").get_array()) {
-                task_graph.add_edge(curr_task, task_map.at(std::string(child.get_string())));
+                builder.add_edge(curr_task, task_map.at(std::string(child.get_string())));
             }
         }
     }
 
+    TaskGraph task_graph = builder.finalize();
+
     /*
     for (Task* task : task_graph.get_tasks()) {
         if (task->get_input_size() == 0) {
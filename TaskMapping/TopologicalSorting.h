@@ -2,40 +2,42 @@
 
 #include "System.h"
 #include "Mapping.h"
+#include "FrozenTaskGraph.h"
+#include "CostTable.h"
+#include "Random.h"
 #include <unordered_map>
 #include <vector>
+#include <deque>
+#include <span>
 #include <queue>
 #include <set>
 #include <map>
+#include <random>
 
+// Tasks and edges that are executed together on a streaming device. The tasks and edges are index ranges into
+// the storage of the owning TopologicalSorting, the devices a bitmask by Device::get_id().
 class SubGraph {
-	std::vector<Task*> tasks;
-	std::vector<Edge*> edges;
-	std::unordered_set<Device const*> devices;
-	std::vector<Edge*> edges_out;
+	std::vector<Task*> const* task_storage;
+	std::vector<Edge*> const* edge_storage;
+	size_t tasks_begin;
+	size_t tasks_end;
+	size_t edges_begin;
+	size_t edges_end;
+	DeviceMask devices;
 
 public:
+	SubGraph(std::vector<Task*> const* task_storage, size_t tasks_begin, size_t tasks_end, std::vector<Edge*> const* edge_storage, size_t edges_begin, size_t edges_end, DeviceMask devices) :
+		task_storage(task_storage), edge_storage(edge_storage), tasks_begin(tasks_begin), tasks_end(tasks_end), edges_begin(edges_begin), edges_end(edges_end), devices(devices)
+	{}
 
-	void add_task(Task* task, Mapping const& mapping) {
-		tasks.push_back(task);
+	std::span<Task* const> get_tasks() const { return { task_storage->data() + tasks_begin, tasks_end - tasks_begin }; }
+	std::span<Edge* const> get_edges() const { return { edge_storage->data() + edges_begin, edges_end - edges_begin }; }
+	DeviceMask get_devices() const { return devices; }
 
-		devices.insert(mapping.get_processor(task));
-		devices.insert(mapping.get_mem_in(task));
-		devices.insert(mapping.get_mem_out(task));
+	template <class MappingType>
+	static DeviceMask get_device_mask(Task* task, MappingType const& mapping) {
+		return (DeviceMask(1) << mapping.get_processor(task)->get_id()) | (DeviceMask(1) << mapping.get_mem_in(task)->get_id()) | (DeviceMask(1) << mapping.get_mem_out(task)->get_id());
 	}
-
-	void add_edge(Edge* edge) {
-		edges.push_back(edge);
-	}
-
-	void add_edge_out(Edge* edge) {
-		edges_out.push_back(edge);
-	}
-
-	std::vector<Task*> get_tasks() const { return tasks; }
-	std::vector<Edge*> get_edges() const { return edges; }
-	std::vector<Edge*> get_edges_out() const { return edges_out; }
-	std::unordered_set<Device const*> get_devices() const { return devices; }
 };
 
 class GraphElement {
@@ -56,227 +58,283 @@ public:
     void release() { ptr = nullptr; }
 };
 
+// Scratch storage of the sorting kernels, reused by repeated sorts
+struct SortingWorkspace {
+	std::vector<size_t> dependencies; // By task id
+	std::vector<size_t> next_elements; // Task id, or number of tasks + edge id
+};
+
 class TopologicalSorting {
 protected:
 	bool insert_edges;
 	std::vector<GraphElement> sorted_elements;
-	std::vector<SubGraph*> subgraphs;
-	mutable std::unordered_map<void*, size_t> index_map;
-    mutable bool dirty = true;
+	std::deque<SubGraph> subgraphs; // Stable addresses for the GraphElements
+	std::vector<Task*> subgraph_tasks; // Storage of all subgraphs, grouped by subgraph
+	std::vector<Edge*> subgraph_edges;
 
 public:
 
 	std::vector<GraphElement> const& get_sorted_elements() const { return sorted_elements; }
-    std::vector<SubGraph*> const& get_subgraphs() const { return subgraphs; }
+    std::deque<SubGraph> const& get_subgraphs() const { return subgraphs; }
     bool contains_edges() const { return insert_edges; }
 
-	void compress_streamable_subtrees(Mapping const& mapping, Processor const* streaming_proc) {
-		SubGraph* compressable_subgraph;
-		do {
-			compressable_subgraph = nullptr;
-
-			std::unordered_map<void*, size_t> dependencies;
-			for (GraphElement const& elem : sorted_elements) {
-				Task* task = elem.get_task();
-				if (task) {
-					dependencies[task] = task->get_edges_in().size();
-				} else if (elem.get_edge()) {
-					dependencies[elem.get_ptr()] = 1;
+	template <class MappingType>
+	static bool is_streamable(Task* task, MappingType const& mapping, Processor const* streaming_proc) {
+		return mapping.get_processor(task) == streaming_proc && task->is_streamable()
+			&& mapping.get_mem_in(task)->is_streaming_device() && mapping.get_mem_out(task)->is_streaming_device();
+	}
+
+	// Replaces each region of tasks that can be streamed together on streaming_proc by a single SubGraph element, in one pass.
+	// A streamable task joins the region of its predecessors if they all belong to the same region or precede it, and the
+	// elements of its in-edges from outside the region precede it as well, otherwise it starts a new region. A region ends
+	// at the first successor that cannot join. The SubGraph takes the position of the first task of the region, which
+	// keeps the sorting topological as all outside dependencies of the region come before. Edges within a region become
+	// part of it.
+	template <class MappingType>
+	void compress_streamable_subtrees(MappingType const& mapping, Processor const* streaming_proc) {
+		size_t constexpr NO_REGION = std::numeric_limits<size_t>::max();
+
+		// Position of the element containing each task and edge, subgraphs of earlier compressions included. Edges that
+		// are not part of the sorting keep NO_POSITION.
+		size_t constexpr NO_POSITION = std::numeric_limits<size_t>::max();
+		size_t nbr_tasks = 0;
+		size_t nbr_edges = 0;
+		for (GraphElement const& elem : sorted_elements) {
+			if (elem.get_task()) {
+				++nbr_tasks;
+			}
+			else if (Edge const* edge = elem.get_edge()) {
+				nbr_edges = std::max<size_t>(nbr_edges, edge->get_id() + 1);
+			}
+			else if (SubGraph const* subgraph = elem.get_subgraph()) {
+				nbr_tasks += subgraph->get_tasks().size();
+				for (Edge const* edge : subgraph->get_edges()) {
+					nbr_edges = std::max<size_t>(nbr_edges, edge->get_id() + 1);
 				}
 			}
-
-			std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t> > wavefront;
-			std::set<size_t> pending;
-			std::map<size_t, size_t> pending_tasks;
-
-			size_t elem_idx = 0;
-			while (elem_idx < sorted_elements.size()) {
-				if (!wavefront.empty() && elem_idx > wavefront.top()) {
-					break;
+		}
+		std::vector<size_t> position(nbr_tasks);
+		std::vector<size_t> edge_position(nbr_edges, NO_POSITION);
+		for (size_t i = 0; i < sorted_elements.size(); ++i) {
+			if (Task* task = sorted_elements[i].get_task()) {
+				position[task->get_id()] = i;
+			}
+			else if (Edge* edge = sorted_elements[i].get_edge()) {
+				edge_position[edge->get_id()] = i;
+			}
+			else if (SubGraph const* subgraph = sorted_elements[i].get_subgraph()) {
+				for (Task* task : subgraph->get_tasks()) {
+					position[task->get_id()] = i;
 				}
-
-				GraphElement const& elem = sorted_elements[elem_idx];
-				if (dependencies[elem.get_ptr()] == 0) {
-					Task* task = elem.get_task();
-					if (task) {
-						if (mapping.get_processor(task) == streaming_proc
-                            && task->is_streamable() && mapping.get_mem_in(task)->is_streaming_device() && mapping.get_mem_out(task)->is_streaming_device()) {
-											
-							while (!wavefront.empty() && elem_idx == wavefront.top()) {
-								wavefront.pop();
-							}							
-							pending.insert(elem_idx);
-
-							for (Edge* edge : task->get_edges_out()) {
-								wavefront.push(get_index(edge));
-								--dependencies[edge];
-							}
-						}
-						else if (pending.empty()) {
-							for (Edge* edge : task->get_edges_out()) {
-								--dependencies[edge];
-							}
-						}
-					}
-
-					Edge* edge = elem.get_edge();
-					if (edge) {
-						if (!wavefront.empty() && elem_idx == wavefront.top()) {
-							wavefront.pop();							
-							pending.insert(elem_idx);
-							pending_tasks[get_index(edge->get_snk())] = elem_idx;
-
-							wavefront.push(get_index(edge->get_snk()));
-							--dependencies[edge->get_snk()];
-						}
-						else if (!compressable_subgraph) {
-							--dependencies[edge->get_snk()];
-						}
-					}					
+				for (Edge* edge : subgraph->get_edges()) {
+					edge_position[edge->get_id()] = i;
 				}
+			}
+		}
 
-				SubGraph* subgraph = elem.get_subgraph();
-				if (subgraph) {
-					if (pending.empty()) {
-						for (Edge* edge : subgraph->get_edges_out()) {
-							--dependencies[edge];
-						}
+		// Assign tasks to regions
+		std::vector<size_t> region(nbr_tasks, NO_REGION);
+		std::vector<size_t> region_start; // Position of the first task
+		std::vector<size_t> region_size;
+		std::vector<DeviceMask> region_devices;
+		std::vector<char> region_closed; // A successor could not join, the region ends there
+		for (size_t i = 0; i < sorted_elements.size(); ++i) {
+			Task* task = sorted_elements[i].get_task();
+			if (!task) {
+				continue;
+			}
+			bool const streamable = is_streamable(task, mapping, streaming_proc);
+
+			// Candidate is the region of the predecessors if there is exactly one
+			size_t joined = NO_REGION;
+			bool unique = true;
+			for (Edge* edge : task->get_edges_in()) {
+				size_t const pred_region = region[edge->get_src()->get_id()];
+				if (pred_region != NO_REGION) {
+					if (joined == NO_REGION) {
+						joined = pred_region;
+					}
+					else if (joined != pred_region) {
+						unique = false;
 					}
 				}
-
-				++elem_idx;
 			}
-
-			if (!pending.empty()) {
-				compressable_subgraph = new SubGraph();
-				subgraphs.push_back(compressable_subgraph);
-
-				size_t last_idx = *pending.rbegin();
-				for (auto it = pending_tasks.rbegin(); it != pending_tasks.rend(); ++it) {
-					if (it->first <= last_idx) {
-						break;
+			if (!streamable || !unique || (joined != NO_REGION && region_closed[joined])) {
+				joined = NO_REGION;
+			}
+			if (joined != NO_REGION) {
+				for (Edge* edge : task->get_edges_in()) {
+					TaskId const pred = edge->get_src()->get_id();
+					size_t const pred_position = region[pred] != NO_REGION ? region_start[region[pred]] : position[pred];
+					if (region[pred] == joined) {
+						continue;
 					}
-					last_idx = std::min(last_idx, it->second - 1);
-				}
-
-				for (size_t idx : pending) {
-					if (idx > last_idx) {
+					// The transfer from outside must also be done before the SubGraph starts
+					size_t const in_edge_position = edge->get_id() < nbr_edges ? edge_position[edge->get_id()] : NO_POSITION;
+					if (pred_position >= region_start[joined] || (in_edge_position != NO_POSITION && in_edge_position >= region_start[joined])) {
+						joined = NO_REGION;
 						break;
 					}
-					GraphElement const& elem = sorted_elements[idx];
-					Task* task = elem.get_task();
-					if (task) {
-						compressable_subgraph->add_task(task, mapping);
-						for (Edge* edge : task->get_edges_out()) {
-							if (get_index(edge) > last_idx) {
-								compressable_subgraph->add_edge_out(edge);
-							}
-						}
-					}
-					Edge* edge = elem.get_edge();
-					if (edge) {
-						compressable_subgraph->add_edge(edge);
+				}
+			}
+			if (joined == NO_REGION) {
+				for (Edge* edge : task->get_edges_in()) {
+					if (region[edge->get_src()->get_id()] != NO_REGION) {
+						region_closed[region[edge->get_src()->get_id()]] = true;
 					}
 				}
 			}
+			if (!streamable) {
+				continue;
+			}
 
-			if (compressable_subgraph) {
-				std::vector<Task*> const& subgraph_tasks = compressable_subgraph->get_tasks();
-				std::vector<Edge*> const& subgraph_edges = compressable_subgraph->get_edges();
-				sorted_elements[get_index(subgraph_tasks.front())] = { compressable_subgraph };
-
-				sorted_elements.erase(std::remove_if(
-					std::begin(sorted_elements), std::end(sorted_elements),
-					[&subgraph_tasks](GraphElement const& elem) -> bool {
-						return std::find(subgraph_tasks.begin(), subgraph_tasks.end(), elem.get_ptr()) != subgraph_tasks.end();
-					}
-				), sorted_elements.end());
+			if (joined == NO_REGION) {
+				joined = region_start.size();
+				region_start.push_back(i);
+				region_size.push_back(0);
+				region_devices.push_back(0);
+				region_closed.push_back(false);
+			}
+			region[task->get_id()] = joined;
+			++region_size[joined];
+			region_devices[joined] |= SubGraph::get_device_mask(task, mapping);
+		}
 
-				sorted_elements.erase(std::remove_if(
-					std::begin(sorted_elements), std::end(sorted_elements),
-					[&subgraph_edges](GraphElement const& elem) -> bool {
-						return std::find(subgraph_edges.begin(), subgraph_edges.end(), elem.get_ptr()) != subgraph_edges.end();
-					}
-				), sorted_elements.end());
+		if (region_start.empty()) {
+			return;
+		}
 
-                dirty = true;
+		// Group tasks and edges by region
+		size_t const nbr_regions = region_start.size();
+		std::vector<size_t> task_offset(nbr_regions + 1, subgraph_tasks.size());
+		std::vector<size_t> edge_offset(nbr_regions + 1, subgraph_edges.size());
+		std::vector<size_t> edge_count(nbr_regions, 0);
+		for (size_t r = 0; r < nbr_regions; ++r) {
+			task_offset[r + 1] = task_offset[r] + region_size[r];
+		}
+		for (GraphElement const& elem : sorted_elements) {
+			if (Edge* edge = elem.get_edge()) {
+				size_t const src_region = region[edge->get_src()->get_id()];
+				if (src_region != NO_REGION && src_region == region[edge->get_snk()->get_id()]) {
+					++edge_count[src_region];
+				}
 			}
+		}
+		for (size_t r = 0; r < nbr_regions; ++r) {
+			edge_offset[r + 1] = edge_offset[r] + edge_count[r];
+		}
+		subgraph_tasks.resize(task_offset[nbr_regions]);
+		subgraph_edges.resize(edge_offset[nbr_regions]);
+
+		std::vector<size_t> next_task(task_offset.begin(), task_offset.end() - 1);
+		std::vector<size_t> next_edge(edge_offset.begin(), edge_offset.end() - 1);
+		std::vector<SubGraph*> region_subgraph(nbr_regions);
+		for (size_t r = 0; r < nbr_regions; ++r) {
+			subgraphs.emplace_back(&subgraph_tasks, task_offset[r], task_offset[r + 1], &subgraph_edges, edge_offset[r], edge_offset[r + 1], region_devices[r]);
+			region_subgraph[r] = &subgraphs.back();
+		}
 
-		} while (compressable_subgraph);
+		// Replace the first task of each region by its subgraph and drop the remaining tasks and inner edges, in place
+		size_t out = 0;
+		for (size_t i = 0; i < sorted_elements.size(); ++i) {
+			GraphElement const elem = sorted_elements[i];
+			if (Task* task = elem.get_task()) {
+				size_t const r = region[task->get_id()];
+				if (r != NO_REGION) {
+					subgraph_tasks[next_task[r]++] = task;
+					if (region_start[r] == i) {
+						sorted_elements[out++] = { region_subgraph[r] };
+					}
+					continue;
+				}
+			}
+			else if (Edge* edge = elem.get_edge()) {
+				size_t const r = region[edge->get_src()->get_id()];
+				if (r != NO_REGION && r == region[edge->get_snk()->get_id()]) {
+					subgraph_edges[next_edge[r]++] = edge;
+					continue;
+				}
+			}
+			sorted_elements[out++] = elem;
+		}
+		sorted_elements.erase(sorted_elements.begin() + out, sorted_elements.end());
 	}
 
-    virtual ~TopologicalSorting() {
-        for (SubGraph* s : subgraphs) {
-            delete s;
-        }
-    }
+    TopologicalSorting(TopologicalSorting const&) = delete; // Subgraphs refer to the storage of their sorting
+    TopologicalSorting& operator=(TopologicalSorting const&) = delete;
+    virtual ~TopologicalSorting() = default;
 
 protected:
     TopologicalSorting(bool insert_edges = true) : insert_edges(insert_edges)
     {}
 
-    size_t get_index(void* elem) const {
-        if (dirty) generate_index();
-        return index_map.contains(elem) ? index_map.at(elem) : -1;
+    // Number of times a task has to be reached before it is ready. Sources are reached once by the initialization.
+    static void initial_dependencies(FrozenTaskGraph const& task_graph, std::vector<size_t>& dependencies) {
+        dependencies.resize(task_graph.nbr_tasks());
+        for (TaskId task = 0; task < task_graph.nbr_tasks(); ++task) {
+            dependencies[task] = std::max(task_graph.get_in_degree(task), (size_t)1);
+        }
     }
 
-	void generate_index() const {
-		index_map.clear();
-		for (size_t i = 0; i < sorted_elements.size(); ++i) {
-			index_map[sorted_elements[i].get_ptr()] = i;
-		}
-        dirty = false;
-	}
+    static std::vector<size_t> initial_dependencies(FrozenTaskGraph const& task_graph) {
+        std::vector<size_t> dependencies;
+        initial_dependencies(task_graph, dependencies);
+        return dependencies;
+    }
+
+    // Empties the sorting, keeps the allocated storage
+    void clear() {
+        sorted_elements.clear();
+        subgraphs.clear();
+        subgraph_tasks.clear();
+        subgraph_edges.clear();
+    }
+
+    void reserve(FrozenTaskGraph const& task_graph) {
+        sorted_elements.reserve(task_graph.nbr_tasks() + (insert_edges ? task_graph.nbr_edges() : 0));
+    }
 };
 
 class RandomSorting : public TopologicalSorting {
-    void sort(TaskGraph const& task_graph) {
-        std::unordered_map<void*, size_t> dependencies;
+    template <class Engine>
+    void sort(FrozenTaskGraph const& task_graph, Engine& rng, SortingWorkspace& workspace) {
+        std::vector<size_t>& dependencies = workspace.dependencies;
+        initial_dependencies(task_graph, dependencies);
+        reserve(task_graph);
 
-        std::vector<GraphElement> next_elements;
-        for (Task* src_task : task_graph.get_src()) {
-            next_elements.push_back(src_task);
-            dependencies[src_task] = 1;
-        }
+        // Ids only, the elements are not dereferenced while sorting
+        size_t const nbr_tasks = task_graph.nbr_tasks();
+        std::vector<size_t>& next_elements = workspace.next_elements;
+        next_elements.assign(task_graph.get_src().begin(), task_graph.get_src().end());
 
         size_t nbr_elements = next_elements.size();
+        auto const push = [&](size_t element) {
+            if (nbr_elements == next_elements.size()) {
+                next_elements.push_back(element);
+            }
+            else {
+                next_elements[nbr_elements] = element;
+            }
+            ++nbr_elements;
+        };
         while (nbr_elements != 0) {
-            int idx = rand() % nbr_elements;
-            GraphElement next_element = next_elements[idx];
-
-            if (--dependencies[next_element.get_ptr()] == 0) {
-                Task* next_task = next_element.get_task();
-                if (next_task) {
-                    for (Edge* edge_out : next_task->get_edges_out()) {
-                        if (nbr_elements == next_elements.size()) {
-                            next_elements.push_back(edge_out);
-                        }
-                        else {
-                            next_elements[nbr_elements] = edge_out;
-                        }
-                        dependencies[edge_out] = 1;
-                        ++nbr_elements;
-                    }
-                }
+            size_t idx = random_index(rng, nbr_elements);
+            size_t const next_element = next_elements[idx];
 
-                Edge* next_edge = next_element.get_edge();
-                if (next_edge) {
-                    Task* snk_task = next_edge->get_snk();
-                    if (nbr_elements == next_elements.size()) {
-                        next_elements.push_back(snk_task);
-                    }
-                    else {
-                        next_elements[nbr_elements] = snk_task;
-                    }
-                    ++nbr_elements;
-
-                    if (!dependencies.contains(snk_task)) {
-                        dependencies[snk_task] = snk_task->get_edges_in().size();
+            if (next_element < nbr_tasks) {
+                if (--dependencies[next_element] == 0) {
+                    for (EdgeId edge_out : task_graph.get_edges_out(next_element)) {
+                        push(nbr_tasks + edge_out);
                     }
+                    sorted_elements.push_back(task_graph.get_task(next_element));
                 }
+            }
+            else {
+                EdgeId const next_edge = next_element - nbr_tasks;
+                push(task_graph.get_edge_snk(next_edge));
 
-                if (insert_edges || next_element.get_task()) {
-                    sorted_elements.push_back(next_element);
+                if (insert_edges) {
+                    sorted_elements.push_back(task_graph.get_edge(next_edge));
                 }
             }
 
@@ -285,189 +343,233 @@ class RandomSorting : public TopologicalSorting {
         }
     }
 public:
-    RandomSorting(TaskGraph const& task_graph, bool insert_edges = true): TopologicalSorting(insert_edges) {
-        sort(task_graph);
+    RandomSorting(bool insert_edges = true): TopologicalSorting(insert_edges) {}
+    // Draws from the given engine, e.g. a stream of RandomStreams for independent sortings on several threads
+    template <class Engine>
+    RandomSorting(FrozenTaskGraph const& task_graph, Engine& rng, bool insert_edges = true): TopologicalSorting(insert_edges) {
+        SortingWorkspace workspace;
+        resample(task_graph, rng, workspace);
+    }
+
+    // Replaces the sorting by a new random one, without allocations once the storage has grown to the graph
+    template <class Engine>
+    void resample(FrozenTaskGraph const& task_graph, Engine& rng, SortingWorkspace& workspace) {
+        clear();
+        sort(task_graph, rng, workspace);
     }
 };
 
 class BFSSorting : public TopologicalSorting {
-    void sort(TaskGraph const& task_graph) {
-        std::unordered_map<void*, size_t> dependencies;
+    void sort(FrozenTaskGraph const& task_graph) {
+        std::vector<size_t> dependencies = initial_dependencies(task_graph);
+        reserve(task_graph);
 
-        std::queue<GraphElement> next_elements;
-        for (Task* src_task : task_graph.get_src()) {
-            next_elements.push(src_task);
-            dependencies[src_task] = 1;
+        // Every edge and every reach of a task is queued once
+        std::vector<GraphElement> next_elements;
+        next_elements.reserve(task_graph.get_src().size() + 2 * task_graph.nbr_edges());
+        for (TaskId src_task : task_graph.get_src()) {
+            next_elements.push_back(task_graph.get_task(src_task));
         }
 
-        while (!next_elements.empty()) {
-            GraphElement next_element = next_elements.front();
-            next_elements.pop();
-
-            if (--dependencies[next_element.get_ptr()] == 0) {
-                Task* next_task = next_element.get_task();
-                if (next_task) {
-                    for (Edge* edge_out : next_task->get_edges_out()) {
-                        GraphElement new_element(edge_out);
-                        next_elements.push(new_element);
-                        dependencies[edge_out] = 1;
-                    }
-                }
+        for (size_t next = 0; next < next_elements.size(); ++next) {
+            GraphElement next_element = next_elements[next];
 
-                Edge* next_edge = next_element.get_edge();
-                if (next_edge) {
-                    Task* snk_task = next_edge->get_snk();
-                    GraphElement new_element(snk_task);
-                    next_elements.push(new_element);
-                    if (!dependencies.contains(snk_task)) {
-                        dependencies[snk_task] = snk_task->get_edges_in().size();
+            Task* next_task = next_element.get_task();
+            if (next_task) {
+                if (--dependencies[next_task->get_id()] == 0) {
+                    for (EdgeId edge_out : task_graph.get_edges_out(next_task->get_id())) {
+                        next_elements.push_back(task_graph.get_edge(edge_out));
                     }
+                    sorted_elements.push_back(next_element);
                 }
+            }
 
-                if (insert_edges || next_element.get_task()) {
+            Edge* next_edge = next_element.get_edge();
+            if (next_edge) {
+                next_elements.push_back(task_graph.get_task(task_graph.get_edge_snk(next_edge->get_id())));
+                if (insert_edges) {
                     sorted_elements.push_back(next_element);
                 }
             }
         }
     }
 public:
-    BFSSorting(TaskGraph const& task_graph, bool insert_edges = true): TopologicalSorting(insert_edges) {
+    BFSSorting(FrozenTaskGraph const& task_graph, bool insert_edges = true): TopologicalSorting(insert_edges) {
         sort(task_graph);
     }
+    BFSSorting(TaskGraph const& task_graph, bool insert_edges = true): BFSSorting(task_graph.freeze(), insert_edges) {}
 };
 
 class TaskFirstBFSSorting : public TopologicalSorting {
-    void sort(TaskGraph const& task_graph) {
-        std::unordered_map<Task*, size_t> dependencies;
+    void sort(FrozenTaskGraph const& task_graph) {
+        std::vector<size_t> dependencies = initial_dependencies(task_graph);
+        reserve(task_graph);
 
-        std::queue<Task*> next_tasks;
-        for (Task* src_task : task_graph.get_src()) {
-            next_tasks.push(src_task);
-            dependencies[src_task] = 1;
-        }
+        // Every reach of a task is queued once
+        std::vector<TaskId> next_tasks;
+        next_tasks.reserve(task_graph.get_src().size() + task_graph.nbr_edges());
+        next_tasks.assign(task_graph.get_src().begin(), task_graph.get_src().end());
 
-        while (!next_tasks.empty()) {
-            Task* next_task = next_tasks.front();
-            next_tasks.pop();
+        for (size_t next = 0; next < next_tasks.size(); ++next) {
+            TaskId next_task = next_tasks[next];
             if (--dependencies[next_task] == 0) {
-                for (Edge* edge_out : next_task->get_edges_out()) {
-                    Task* const snk_task = edge_out->get_snk();
-                    next_tasks.push(snk_task);
-                    if (!dependencies.contains(snk_task)) {
-                        dependencies[snk_task] = snk_task->get_edges_in().size();
-                    }
+                for (EdgeId edge_out : task_graph.get_edges_out(next_task)) {
+                    next_tasks.push_back(task_graph.get_edge_snk(edge_out));
                 }
                 if (insert_edges) {
-                    for (Edge* edge_in : next_task->get_edges_in()) {
-                        sorted_elements.push_back(edge_in);
+                    for (EdgeId edge_in : task_graph.get_edges_in(next_task)) {
+                        sorted_elements.push_back(task_graph.get_edge(edge_in));
                     }
                 }
-                sorted_elements.push_back(next_task);
+                sorted_elements.push_back(task_graph.get_task(next_task));
             }
         }
     }
 public:
-    TaskFirstBFSSorting(TaskGraph const& task_graph, bool insert_edges = true): TopologicalSorting(insert_edges) {
+    TaskFirstBFSSorting(FrozenTaskGraph const& task_graph, bool insert_edges = true): TopologicalSorting(insert_edges) {
         sort(task_graph);
     }
+    TaskFirstBFSSorting(TaskGraph const& task_graph, bool insert_edges = true): TaskFirstBFSSorting(task_graph.freeze(), insert_edges) {}
 };
 
+// Schedules the ready task of the processor with the earliest ready time next, in the order the tasks became ready.
+// Edges between processors are inserted first if one of the two processors is that of the next task and both are
+// ready before the task would finish. Ready tasks wait in a FIFO queue per processor and crossing edges in a FIFO queue
+// per pair of processors, as every element of a queue competes with the same times. Each step only compares the queue
+// fronts, O((V + E) P) for P processors.
 class MappingBasedSorting : public TopologicalSorting {
-    void sort(System const& sys, Mapping const& mapping) {
-        std::unordered_map<Task*, size_t> dependencies;
-
-        std::vector<Task*> next_tasks;
-        std::vector<Edge*> crossing_edges;
-        for (Task* src_task : sys.get_task_graph().get_src()) {
-            next_tasks.push_back(src_task);
-        }
-
-        std::unordered_map<Processor const*, Time> times;
-        for (Processor const* proc: sys.get_platform().get_processors()) {
-            times[proc] = 0;
+    template <class MappingType, class ComputationTime>
+    void sort(System const& sys, MappingType const& mapping, ComputationTime const& computation_time) {
+        FrozenTaskGraph const& task_graph = sys.get_task_graph().freeze();
+        std::vector<size_t> dependencies = initial_dependencies(task_graph);
+        size_t const nbr_procs = sys.get_platform().get_processors().size();
+
+        // Entries carry the position in the ready order of all tasks or all crossing edges, which breaks ties
+        std::vector<std::deque<std::pair<size_t, TaskId>>> ready_tasks(nbr_procs); // By Processor::get_index()
+        std::vector<std::deque<std::pair<size_t, Edge*>>> crossing_edges(nbr_procs * nbr_procs); // By source and sink processor
+        size_t nbr_ready_tasks = 0;
+        size_t nbr_crossing_edges = 0;
+        size_t pending_edges = 0;
+
+        auto const proc_index = [&](Task* task) { return mapping.get_processor(task)->get_index(); };
+        auto const make_ready = [&](TaskId task) {
+            ready_tasks[proc_index(task_graph.get_task(task))].emplace_back(nbr_ready_tasks++, task);
+        };
+        for (TaskId src_task : task_graph.get_src()) {
+            make_ready(src_task);
         }
 
-        size_t first_task_idx = 0;
-        size_t first_edge_idx = 0;
-        while (first_task_idx < next_tasks.size() || first_edge_idx < crossing_edges.size()) {
-            Time min_time = std::numeric_limits<Time>::max();
-            size_t min_idx = std::numeric_limits<size_t>::max();
+        std::vector<Time> times(nbr_procs, 0); // By Processor::get_index()
 
-            for (size_t i=first_task_idx; i < next_tasks.size(); ++i) {
-                if (next_tasks[i] && times.at(mapping.get_processor(next_tasks[i])) < min_time) {
-                    min_time = times.at(mapping.get_processor(next_tasks[i]));
-                    min_idx = i;
+        while (true) {
+            // Task of the processor with the earliest time, ties to the earliest ready
+            size_t proc = nbr_procs;
+            for (size_t p = 0; p < nbr_procs; ++p) {
+                if (!ready_tasks[p].empty() && (proc == nbr_procs || times[p] < times[proc] || (times[p] == times[proc] && ready_tasks[p].front().first < ready_tasks[proc].front().first))) {
+                    proc = p;
                 }
             }
+            if (proc == nbr_procs && pending_edges == 0) {
+                break;
+            }
 
-            Task* next_task = (first_task_idx < next_tasks.size()) ? next_tasks[min_idx] : nullptr;
-            Processor const* const proc = next_task ? mapping.get_processor(next_task) : nullptr;
-            Time new_time = (next_task ? min_time + sys.computation_time_ms(next_task, proc) : std::numeric_limits<Time>::max());
-
-            Edge* next_edge = nullptr;
-            for (size_t i=first_edge_idx; i < crossing_edges.size(); ++i) {
-                if (crossing_edges[i]) {
-                    Processor const* const proc_src = mapping.get_processor(crossing_edges[i]->get_src());
-                    Processor const* const proc_snk = mapping.get_processor(crossing_edges[i]->get_snk());
-                    if (!next_task || ((proc == proc_src || proc == proc_snk) && new_time > std::max(times[proc_src], times[proc_snk]))) {
-                        next_edge = crossing_edges[i];
-                        crossing_edges[i] = nullptr;
-
-                        while (first_edge_idx < crossing_edges.size() && crossing_edges[first_edge_idx] == nullptr) {
-                            ++first_edge_idx;
-                        }
-                        break;
+            Task* const next_task = proc < nbr_procs ? task_graph.get_task(ready_tasks[proc].front().second) : nullptr;
+            Time const new_time = next_task ? times[proc] + computation_time(next_task, mapping.get_processor(next_task)) : std::numeric_limits<Time>::max();
+
+            // Earliest crossing edge from or to proc whose processors are both ready before new_time, any edge without a task
+            std::deque<std::pair<size_t, Edge*>>* edge_queue = nullptr;
+            auto const consider = [&](size_t src_proc, size_t snk_proc) {
+                std::deque<std::pair<size_t, Edge*>>& queue = crossing_edges[src_proc * nbr_procs + snk_proc];
+                if (!queue.empty() && (!next_task || new_time > std::max(times[src_proc], times[snk_proc])) && (!edge_queue || queue.front().first < edge_queue->front().first)) {
+                    edge_queue = &queue;
+                }
+            };
+            for (size_t p = 0; p < nbr_procs; ++p) {
+                if (!next_task) {
+                    for (size_t q = 0; q < nbr_procs; ++q) {
+                        consider(p, q);
+                    }
+                }
+                else {
+                    consider(proc, p);
+                    if (p != proc) {
+                        consider(p, proc);
                     }
                 }
             }
 
-            if (next_edge) {
+            if (edge_queue) {
+                Edge* const next_edge = edge_queue->front().second;
+                edge_queue->pop_front();
+                --pending_edges;
                 if (insert_edges) {
                     sorted_elements.push_back(next_edge);
                 }
-                if (--dependencies[next_edge->get_snk()] == 0) {
-                    next_tasks.push_back(next_edge->get_snk());
+                if (--dependencies[next_edge->get_snk()->get_id()] == 0) {
+                    make_ready(next_edge->get_snk()->get_id());
                 }
             } else {
-                next_tasks[min_idx] = nullptr;
+                ready_tasks[proc].pop_front();
                 times[proc] = new_time;
-                while (first_task_idx < next_tasks.size() && next_tasks[first_task_idx] == nullptr) {
-                    ++first_task_idx;
-                }
 
                 sorted_elements.push_back(next_task);
 
-                for (Edge* edge_out: next_task->get_edges_out()) {
+                for (EdgeId edge_id : task_graph.get_edges_out(next_task->get_id())) {
+                    Edge* const edge_out = task_graph.get_edge(edge_id);
                     Task* const snk_task = edge_out->get_snk();
-                    if (!dependencies.contains(snk_task)) {
-                        dependencies[snk_task] = snk_task->get_edges_in().size();
-                    }
+                    size_t const snk_proc = proc_index(snk_task);
 
-                    if (mapping.get_processor(snk_task) == proc) {
+                    if (snk_proc == proc) {
                         if (insert_edges) {
                             sorted_elements.push_back(edge_out);
                         }
-                        if (--dependencies[snk_task] == 0) {
-                            next_tasks.push_back(snk_task);
+                        if (--dependencies[snk_task->get_id()] == 0) {
+                            make_ready(snk_task->get_id());
                         }
                     } else {
-                        crossing_edges.push_back(edge_out);
+                        crossing_edges[proc * nbr_procs + snk_proc].emplace_back(nbr_crossing_edges++, edge_out);
+                        ++pending_edges;
                     }
                 }
             }
         }
     }
 public:
-    MappingBasedSorting(System const& sys, Mapping const& mapping, bool insert_edges = true): TopologicalSorting(insert_edges) {
-        sort(sys, mapping);
+    template <class MappingType>
+    MappingBasedSorting(System const& sys, MappingType const& mapping, bool insert_edges = true): TopologicalSorting(insert_edges) {
+        sort(sys, mapping, [&sys](Task* task, Processor const* proc) { return sys.computation_time_ms(task, proc); });
+    }
+    // Same order with the computation times looked up in the table instead of calling the System
+    template <class MappingType>
+    MappingBasedSorting(System const& sys, CostTable const& costs, MappingType const& mapping, bool insert_edges = true): TopologicalSorting(insert_edges) {
+        sort(sys, mapping, [&costs](Task* task, Processor const* proc) { return costs.computation_time(task, proc); });
     }
 };
 
 class CachedSorting : public TopologicalSorting {
 public:
+    CachedSorting() = default;
+
     CachedSorting(TopologicalSorting const* sorting) : TopologicalSorting(sorting->contains_edges()) {
+        assign(sorting);
+    }
+
+    // Replaces the content by a copy of sorting, keeps the allocated storage
+    void assign(TopologicalSorting const* sorting) {
         assert(sorting->get_subgraphs().empty()); // Caching with subgraphs not implemented yet
-        sorted_elements = sorting->get_sorted_elements();
+        clear();
+        insert_edges = sorting->contains_edges();
+        sorted_elements.assign(sorting->get_sorted_elements().begin(), sorting->get_sorted_elements().end());
+    }
+
+    // Moves the element at position from to position to, the elements in between move by one
+    void move_element(size_t from, size_t to) {
+        if (to <= from) {
+            std::rotate(sorted_elements.begin() + to, sorted_elements.begin() + from, sorted_elements.begin() + from + 1);
+        }
+        else {
+            std::rotate(sorted_elements.begin() + from, sorted_elements.begin() + from + 1, sorted_elements.begin() + to + 1);
+        }
     }
 };
 
@@ -2,7 +2,7 @@
 
 int main(int argc, char* argv[]) {
 
-	int SEED = (int)time(NULL);
+	[[maybe_unused]] int SEED = (int)time(NULL); // Used by the test calls below, which are commented out
 	const int DEFAULT_RUNS = 100;
 	const int DEFAULT_GRAPH_SIZE = 100;
     const int DATA_IN_MB = 100;
@@ -23,7 +23,7 @@ int main(int argc, char* argv[]) {
 		}
 	}
 
-	if (GRAPH_SIZE < 1 || GRAPH_SIZE > 1000) {
+	if (GRAPH_SIZE < 1 || GRAPH_SIZE > 1000000) {
 		GRAPH_SIZE = DEFAULT_GRAPH_SIZE;
 	}
 
@@ -31,29 +31,31 @@ int main(int argc, char* argv[]) {
 		RUNS = DEFAULT_RUNS;
 	}
 
-	srand(SEED);
-	
 	std::cout << "No tests activated, uncomment tests in main.cpp to execute them" << std::endl;
 	
 	// Note: For MappingType::ZhouLiu activate specialized code in test_size_series instead (performance issues)
-    //test_size_series(SEED, 5, 1, 30, 30, [&DATA_IN_MB](int size){return generate_random_series_parallel_graph(size, DATA_IN_MB);}, { Configuration::CGF },
+    //test_size_series(SEED, 5, 1, 30, 30, [&DATA_IN_MB](int size, Xoshiro256& rng){return generate_random_series_parallel_graph(rng, size, DATA_IN_MB);}, { Configuration::CGF },
     //    {MappingType::CPU, MappingType::SingleNode, MappingType::SeriesParallel, MappingType::DeviceMILP, MappingType::TimeMILPStream}); 
 	
-    //test_size_series(SEED, 5, 5, 200, 30, [&DATA_IN_MB](int size){return generate_random_series_parallel_graph(size, DATA_IN_MB);}, { Configuration::CGF },
+    //test_size_series(SEED, 5, 5, 200, 30, [&DATA_IN_MB](int size, Xoshiro256& rng){return generate_random_series_parallel_graph(rng, size, DATA_IN_MB);}, { Configuration::CGF },
     //    {MappingType::CPU, MappingType::SingleNode, MappingType::SNFirstFit, MappingType::SeriesParallel, MappingType::SPFirstFit, MappingType::HEFT, MappingType::PEFT}); 
 
-    //test_size_series(SEED, 5, 5, 100, 30, [&DATA_IN_MB](int size){return generate_random_series_parallel_graph(size, DATA_IN_MB);}, { Configuration::CGF },
+    //test_size_series(SEED, 5, 5, 100, 30, [&DATA_IN_MB](int size, Xoshiro256& rng){return generate_random_series_parallel_graph(rng, size, DATA_IN_MB);}, { Configuration::CGF },
     //    {MappingType::CPU, MappingType::SNFirstFit, MappingType::SPFirstFit, MappingType::SA, MappingType::NSGAII});
 		
-	//test_nsgaii_generation_series(SEED, 50, 50, 500, 30, [&DATA_IN_MB]() {return generate_random_series_parallel_graph(200, DATA_IN_MB);}, { Configuration::CGF }, 
+	//test_nsgaii_generation_series(SEED, 50, 50, 500, 30, [&DATA_IN_MB](Xoshiro256& rng) {return generate_random_series_parallel_graph(rng, 200, DATA_IN_MB);}, { Configuration::CGF }, 
 	//	{ MappingType::CPU, MappingType::SPFirstFit, MappingType::SNFirstFit });
 	
-    //test_size_series(SEED, 0, 5, 200, 30, [&DATA_IN_MB](int loose_edges) {return generate_random_almost_series_parallel_graph(100, DATA_IN_MB, loose_edges);}, { Configuration::CGF },
+    //test_size_series(SEED, 0, 5, 200, 30, [&DATA_IN_MB](int loose_edges, Xoshiro256& rng) {return generate_random_almost_series_parallel_graph(rng, 100, DATA_IN_MB, loose_edges);}, { Configuration::CGF },
     //                 {MappingType::CPU, MappingType::HEFT, MappingType::PEFT, MappingType::SPFirstFit, MappingType::SNFirstFit, MappingType::NSGAII});
 
 	//test_benchmark_graphs(SEED, 10, { Configuration::CGF },
 	//	{ "makeflow/blast", "pegasus/1000genome", "pegasus/cycles", "pegasus/epigenomics", "pegasus/montage", "pegasus/soykb", "pegasus/srasearch" },
 	//	{ MappingType::CPU, MappingType::HEFT, MappingType::PEFT, MappingType::SPFirstFit, MappingType::SNFirstFit, MappingType::NSGAII });
 
+	//test_event_simulation(SEED, 100000, 10, Configuration::CG);
+
+	//test_system_dispatch(SEED, 100000, 10, Configuration::CGF);
+
 	return 0;
 }
@@ -14,6 +14,7 @@
 
 #include "Evaluation.h"
 #include "DrawGraph.h"
+#include "ScheduleTrace.h"
 #include "GraphExport.h"
 
 #include "ResultHandling.h"
@@ -33,15 +34,23 @@ enum class MappingType {
     HEFT, PEFT
 };
 
-void run_mapping(std::string const& label, System const& system, Mapper const& mapper, TestRun& test_run, bool draw = true, bool enable_export = false) {
+// The final check of the schedule draws from streams.fork("check")
+void run_mapping(std::string const& label, System const& system, Mapper const& mapper, TestRun& test_run, bool draw = true, bool enable_export = false, RandomStreams const& streams = RandomStreams()) {
 
 	std::cout << "Computing " << label << "...";
 
+	// The caches of the mapper are gone when it returns, so their statistics are in the totals
+	EvaluationCache::Statistics const cache_before = EvaluationCache::get_total_statistics();
 	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
 	Mapping mapping = mapper.get_task_mapping(system);
 	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	EvaluationCache::Statistics const cache = EvaluationCache::get_total_statistics() - cache_before;
 
-	std::cout << " finished!" << std::endl;
+	std::cout << " finished!";
+	if (cache.lookups() > 0) {
+		std::cout << " Cache hits: " << cache.hits << " of " << cache.lookups();
+	}
+	std::cout << std::endl;
 
     if (mapping.empty()) {
         test_run.push_back({ label, std::numeric_limits<Time>::infinity(), std::chrono::milliseconds::max(), true });
@@ -49,14 +58,17 @@ void run_mapping(std::string const& label, System const& system, Mapper const& m
     }
 
 	MappingEvaluator eval(system, true);
-	Time result = eval.evaluate_mapping_with_check(mapping, 100);
+	Time result = eval.evaluate_mapping_with_check(mapping, 100, 0, streams.fork("check"));
 
 	if (result == -1) {
 		std::cerr << "No mapping found for " << label << std::endl;
 		return;
 	}
 
-	if (draw) draw_graph(system.get_task_graph(), mapping, label, eval.get_log());
+	if (draw) {
+		draw_graph(system.get_task_graph(), mapping, label, eval.get_log());
+		export_schedule_trace(system, mapping, label, eval.get_log());
+	}
 	if (enable_export) export_graph(system.get_task_graph(), mapping, label);
 	test_run.push_back({ label, result, std::chrono::duration_cast<std::chrono::milliseconds>(end - begin), false });
 }
@@ -102,16 +114,20 @@ void run_mapping_with_schedule(std::string const& label, System const& system, T
 		return;
 	}
 
-	if (draw) draw_graph(system.get_task_graph(), mapping, label, eval.get_log());
+	if (draw) {
+		draw_graph(system.get_task_graph(), mapping, label, eval.get_log());
+		export_schedule_trace(system, mapping, label, eval.get_log());
+	}
 	if (enable_export) export_graph(system.get_task_graph(), mapping, label);
 	test_run.push_back({ label, result, std::chrono::duration_cast<std::chrono::milliseconds>(end - begin) });
 }
 
-void run_nsgaii_mapping(System const& system, TestRun& test_run, size_t generations) {
-	run_mapping("NSGAIIMapping", system, NSGAIIMapper(generations), test_run, false);
+void run_nsgaii_mapping(System const& system, TestRun& test_run, size_t generations, RandomStreams const& streams = RandomStreams()) {
+	run_mapping("NSGAIIMapping", system, NSGAIIMapper(generations, streams.fork("NSGAIIMapping")), test_run, false, false, streams.fork("NSGAIIMapping"));
 }
 
-void run_mappings(System const& system, TestRun& test_run, std::vector<MappingType> selection, bool draw_results, bool enable_export = false) {
+// Every mapping draws from the streams forked from streams by its label, so its result does not depend on the selection
+void run_mappings(System const& system, TestRun& test_run, std::vector<MappingType> selection, bool draw_results, bool enable_export = false, RandomStreams const& streams = RandomStreams()) {
 	struct BasePolicies {
 		typedef EvaluateAll EvaluationPolicy;
 		typedef GreedyBase BaseMappingPolicy;
@@ -133,7 +149,7 @@ void run_mappings(System const& system, TestRun& test_run, std::vector<MappingTy
 	};
 
     auto run_func = [&](std::string const& label, Mapper const& mapper) {
-        run_mapping(label, system, mapper, test_run, draw_results, enable_export);
+        run_mapping(label, system, mapper, test_run, draw_results, enable_export, streams.fork(label));
     };
 
     for (MappingType const& mptype : selection) {
@@ -166,13 +182,13 @@ void run_mappings(System const& system, TestRun& test_run, std::vector<MappingTy
                 run_func("SNFirstFitMapping", SingleNodeDecompositionMapper<FirstFitPolicy>());
                 break;
 			case MappingType::SimulatedAnnealing:
-				run_func("SimulatedAnnealingMapping", SimulatedAnnealingMapper());
+				run_func("SimulatedAnnealingMapping", SimulatedAnnealingMapper(streams.fork("SimulatedAnnealingMapping")));
 				break;
 			case MappingType::NSGAII:
-				run_func("NSGAIIMapping", NSGAIIMapper());
+				run_func("NSGAIIMapping", NSGAIIMapper(500, streams.fork("NSGAIIMapping")));
 				break;
 			case MappingType::NSGAIISimple:
-				run_func("NSGAIIMappingSummed", NSGAIIMapper<SummedEvaluation>());
+				run_func("NSGAIIMappingSummed", NSGAIIMapper<SummedEvaluation>(500, streams.fork("NSGAIIMappingSummed")));
 				break;
             case MappingType::HEFT:
                 run_func("HEFTMapping", HEFTMapper());
@@ -201,6 +217,6 @@ void run_mappings(System const& system, TestRun& test_run, std::vector<MappingTy
 	//run_mapping_with_schedule("PEFTMappingSchedule", system, PEFTMapper(), test_run, draw_results, enable_export);
 }
 
-void run_default_mappings(System const& system, TestRun& test_run, bool draw_results, bool enable_export = false) {
-    run_mappings(system, test_run, {MappingType::CPU, MappingType::SeriesParallel, MappingType::SPFirstFit, MappingType::SingleNode, MappingType::SNFirstFit, MappingType::SimulatedAnnealing, MappingType::NSGAII, MappingType::HEFT, MappingType::PEFT, MappingType::DeviceMILP}, draw_results, enable_export);
+void run_default_mappings(System const& system, TestRun& test_run, bool draw_results, bool enable_export = false, RandomStreams const& streams = RandomStreams()) {
+    run_mappings(system, test_run, {MappingType::CPU, MappingType::SeriesParallel, MappingType::SPFirstFit, MappingType::SingleNode, MappingType::SNFirstFit, MappingType::SimulatedAnnealing, MappingType::NSGAII, MappingType::HEFT, MappingType::PEFT, MappingType::DeviceMILP}, draw_results, enable_export, streams);
 }
@@ -33,15 +33,18 @@ void test_find_small_mapping(int seed, int graph_size, Configuration config, boo
 
 	std::cout << "Executing configuration " << label(config) << " with Seed " << seed << std::endl;
 
+	RandomStreams const streams(seed);
 	ComputationBasedSystem system(TaskGraph(), create_platform(nbr_fpgas(config)));
 	std::vector<TestRun> results;
 	for (int i = 0; i < RUNS; ++i) {
 		std::cout << "Run " << i + 1 << " of " << RUNS << "...";
-		system.replace_graph(generate_random_series_parallel_graph(graph_size));
+		RandomStreams const run_streams = streams.fork(i);
+		Xoshiro256 graph_rng = run_streams.stream("graph");
+		system.replace_graph(generate_random_series_parallel_graph(graph_rng, graph_size));
 		results.push_back(TestRun());
 		TestRun& test_run = results.back();
 
-        run_default_mappings(system, test_run, draw_results);
+        run_default_mappings(system, test_run, draw_results, false, run_streams);
 		std::cout << "finished!" << std::endl;
 
 		//	Find nice small mapping
@@ -55,10 +58,13 @@ void test_find_small_mapping(int seed, int graph_size, Configuration config, boo
 	}
 }
 
+// Every run draws its graph and the random decisions of the mappers from its own streams, forked from the seed by
+// configuration and run, so a run can be reproduced on its own and independent of the number of threads.
 void test_performance(int seed, int graph_size, int runs, std::vector<Configuration> const& configurations) {
 	bool draw_results = (runs == 1);
 	prepare_files();
 	write_log(seed);
+	RandomStreams const streams(seed);
 
 	for (auto& config : configurations) {
 		std::cout << "Executing configuration " << label(config) << " with Seed " << seed << std::endl;
@@ -69,11 +75,13 @@ void test_performance(int seed, int graph_size, int runs, std::vector<Configurat
 		std::vector<TestRun> results;
 		for (int i = 0; i < runs; ++i) {
 			std::cout << "Run " << i + 1 << " of " << runs << "...";
-			system.replace_graph(generate_random_series_parallel_graph(graph_size));
+			RandomStreams const run_streams = streams.fork(label(config)).fork(i);
+			Xoshiro256 graph_rng = run_streams.stream("graph");
+			system.replace_graph(generate_random_series_parallel_graph(graph_rng, graph_size));
 			results.push_back(TestRun());
 			TestRun& test_run = results.back();
 
-            run_default_mappings(system, test_run, draw_results);
+            run_default_mappings(system, test_run, draw_results, false, run_streams);
 			std::cout << "finished!" << std::endl;
 
 			if (runs == 1) print_results(test_run);
@@ -115,6 +123,7 @@ void test_benchmark_graphs(int seed, int runs, std::vector<Configuration> const&
 
 	std::string benchmark_base_folder;
 	if (!get_basefolder(benchmark_base_folder)) return;
+	RandomStreams const streams(seed);
 
 	for (auto& config : configurations) {
 		std::cout << "Executing configuration " << label(config) << " with Seed " << seed << std::endl;
@@ -145,7 +154,7 @@ void test_benchmark_graphs(int seed, int runs, std::vector<Configuration> const&
 					results.push_back(TestRun());
 					TestRun& test_run = results.back();
 
-					run_mappings(system, test_run, selection, false);
+					run_mappings(system, test_run, selection, false, false, streams.fork(label(config)).fork(entry.path().generic_string()).fork(i));
 
 					if (runs == 1) print_results(test_run);
 				}
@@ -177,14 +186,17 @@ void dump_benchmark_graphs(std::vector<std::string> const& paths) {
 	}
 }
 
-void test_performance_and_export(int seed, std::function<TaskGraph ()> const& graph_gen, std::vector<Configuration> const& configurations, std::ostream& out = std::cout, TestRun* out_run = nullptr) {
+void test_performance_and_export(int seed, std::function<TaskGraph (Xoshiro256&)> const& graph_gen, std::vector<Configuration> const& configurations, std::ostream& out = std::cout, TestRun* out_run = nullptr) {
 	prepare_files();
 	write_log(seed);
+	RandomStreams const streams(seed);
 
 	for (auto& config : configurations) {
 		out << "Executing configuration " << label(config) << " with Seed " << seed << std::endl;
 
-		ComputationBasedSystem system(graph_gen(), create_platform(nbr_fpgas(config)));
+		RandomStreams const run_streams = streams.fork(label(config));
+		Xoshiro256 graph_rng = run_streams.stream("graph");
+		ComputationBasedSystem system(graph_gen(graph_rng), create_platform(nbr_fpgas(config)));
 		if (system.get_task_graph().get_tasks().size() == 0) {
 			return;
 		}
@@ -192,10 +204,10 @@ void test_performance_and_export(int seed, std::function<TaskGraph ()> const& gr
 		draw_hardware_graph(system.get_platform(), "hardware_graph_" + label(config));
 
         if (out_run) {
-            run_default_mappings(system, *out_run, false, true);
+            run_default_mappings(system, *out_run, false, true, run_streams);
         } else {
             TestRun test_run;
-            run_default_mappings(system, test_run, true, true);
+            run_default_mappings(system, test_run, true, true, run_streams);
 
             print_results(test_run);
             results_to_file({test_run}, "statistics.txt", label(config), true);
@@ -203,9 +215,10 @@ void test_performance_and_export(int seed, std::function<TaskGraph ()> const& gr
 	}
 }
 
-void test_size_series(int seed, int from, int step, int to, int runs, std::function<TaskGraph(int)> const& graph_gen, std::vector<Configuration> const& configurations, std::vector<MappingType> selection = {}) {
+void test_size_series(int seed, int from, int step, int to, int runs, std::function<TaskGraph(int, Xoshiro256&)> const& graph_gen, std::vector<Configuration> const& configurations, std::vector<MappingType> selection = {}) {
 	prepare_files();
 	write_log(seed);
+	RandomStreams const streams(seed);
 
     std::ofstream ofs("results/size_series_out.txt", std::ios_base::app);
 	for (auto& config : configurations) {
@@ -219,17 +232,19 @@ void test_size_series(int seed, int from, int step, int to, int runs, std::funct
             std::vector<TestRun>& results = test_runs.back().second;
             for (int i = 0; i < runs; ++i) {
                 std::cout << "Run " << i + 1 << " of " << runs << "...";
-                system.replace_graph(graph_gen(size));
+                RandomStreams const run_streams = streams.fork(label(config)).fork(size).fork(i);
+                Xoshiro256 graph_rng = run_streams.stream("graph");
+                system.replace_graph(graph_gen(size, graph_rng));
                 results.push_back(TestRun());
                 TestRun& test_run = results.back();
 
                 if (selection.empty()) {
-                    run_default_mappings(system, test_run, false, false);
+                    run_default_mappings(system, test_run, false, false, run_streams);
                     /*if (size <= 20 && size % 5 == 0) {
-                        run_mappings(system, test_run, {MappingType::ZhouLiu}, false, false);
+                        run_mappings(system, test_run, {MappingType::ZhouLiu}, false, false, run_streams);
                     }*/
                 } else {
-                    run_mappings(system, test_run, selection, false, false);
+                    run_mappings(system, test_run, selection, false, false, run_streams);
                 }
                 std::cout << "finished!" << std::endl;
             }
@@ -239,9 +254,11 @@ void test_size_series(int seed, int from, int step, int to, int runs, std::funct
 	}
 }
 
-void test_nsgaii_generation_series(int seed, int from, int step, int to, int runs, std::function<TaskGraph()> const& graph_gen, std::vector<Configuration> const& configurations, std::vector<MappingType> additional_selection = {}) {
+// All generation counts of a run start from the same streams, so they only differ in the number of generations
+void test_nsgaii_generation_series(int seed, int from, int step, int to, int runs, std::function<TaskGraph(Xoshiro256&)> const& graph_gen, std::vector<Configuration> const& configurations, std::vector<MappingType> additional_selection = {}) {
 	prepare_files();
 	write_log(seed);
+	RandomStreams const streams(seed);
 
 	std::ofstream ofs("results/nsgaii_series_out.txt", std::ios_base::app);
 
@@ -259,10 +276,12 @@ void test_nsgaii_generation_series(int seed, int from, int step, int to, int run
 
 		for (int run = 0; run < runs; ++run) {
 
-			system.replace_graph(graph_gen());
+			RandomStreams const run_streams = streams.fork(label(config)).fork(run);
+			Xoshiro256 graph_rng = run_streams.stream("graph");
+			system.replace_graph(graph_gen(graph_rng));
 
 			TestRun selection_run = TestRun();
-			run_mappings(system, selection_run, additional_selection, false, false);
+			run_mappings(system, selection_run, additional_selection, false, false, run_streams);
 
 			auto it = nsgaii_test_runs.begin();
 			for (int generations = from; generations <= to; generations += step) {
@@ -270,7 +289,7 @@ void test_nsgaii_generation_series(int seed, int from, int step, int to, int run
 				it->second.push_back(selection_run);
 				TestRun& curr_run = it->second.back();
 
-				run_nsgaii_mapping(system, curr_run, generations);
+				run_nsgaii_mapping(system, curr_run, generations, run_streams);
 				++it;
 			}
 		}
@@ -278,4 +297,99 @@ void test_nsgaii_generation_series(int seed, int from, int step, int to, int run
 		ofs << "\nConfiguration " << label(config) << " (Seed " << seed << ")" << std::endl;
 		create_plot(nsgaii_test_runs, ofs);
 	}
+}
+
+// Compares the evaluation of the TASK_FIRST_BFS sorting with the event-driven simulation. Each run maps the tasks of a
+// random series-parallel graph to random compatible processors and their default memories.
+void test_event_simulation(int seed, int graph_size, int runs, Configuration config) {
+	RandomStreams const streams(seed);
+	Xoshiro256 graph_rng = streams.stream("graph");
+	Xoshiro256 rng = streams.stream("mappings");
+	ComputationBasedSystem system(generate_random_series_parallel_graph(graph_rng, graph_size), create_platform(nbr_fpgas(config)));
+	MappingEvaluator eval(system);
+	EventSimulator simulator(system, eval.get_costs());
+	TopologicalSorting const& sorting = *eval.get_context()->get_sorting(SORTING_MODE::TASK_FIRST_BFS);
+	std::vector<Processor*> const& processors = system.get_platform().get_processors();
+
+	std::chrono::steady_clock::duration sorting_duration{}, event_duration{};
+	Time sorting_cost = 0, event_cost = 0;
+	for (int run = 0; run < runs; ++run) {
+		DenseMapping mapping(system);
+		for (Task* task : system.get_task_graph().get_tasks()) {
+			Processor* processor;
+			do {
+				processor = processors[random_index(rng, processors.size())];
+			} while (!eval.get_costs().is_compatible(task, processor));
+			mapping.map(task, processor);
+		}
+
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		sorting_cost += eval.compute_cost_with_sorting(mapping, sorting);
+		std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+		event_cost += simulator.simulate(mapping);
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		sorting_duration += middle - begin;
+		event_duration += end - middle;
+	}
+
+	std::cout << "Configuration " << label(config) << ", " << graph_size << " tasks, " << runs << " mappings (Seed " << seed << ")" << std::endl;
+	std::cout << "Sorting evaluation: mean cost " << sorting_cost / runs << ", " << std::chrono::duration_cast<std::chrono::microseconds>(sorting_duration).count() / runs << " us per mapping" << std::endl;
+	std::cout << "Event simulation:   mean cost " << event_cost / runs << ", " << std::chrono::duration_cast<std::chrono::microseconds>(event_duration).count() / runs << " us per mapping" << std::endl;
+}
+
+// Sum of the costs of all tasks on all compatible processors with their default memories, through the System calls
+template <class SystemType>
+Time sum_system_costs(SystemType const& sys) {
+	Time sum = 0;
+	for (Task* task : sys.get_task_graph().get_tasks()) {
+		for (Processor const* processor : sys.get_platform().get_processors()) {
+			if (sys.is_compatible(task, processor)) {
+				Memory const* memory = processor->get_default_memory();
+				sum += sys.transaction_time_ms(task->get_input_size(), memory, processor) + sys.computation_time_ms(task, processor) + sys.transaction_time_ms(task->get_output_size(), processor, memory);
+			}
+		}
+	}
+	return sum;
+}
+
+// Same sum from the precomputed table
+Time sum_table_costs(System const& sys, CostTable const& costs) {
+	Time sum = 0;
+	for (Task* task : sys.get_task_graph().get_tasks()) {
+		for (Processor const* processor : sys.get_platform().get_processors()) {
+			if (costs.is_compatible(task, processor)) {
+				Memory const* memory = processor->get_default_memory();
+				sum += costs.input_time(task, memory, processor) + costs.computation_time(task, processor) + costs.output_time(task, processor, memory);
+			}
+		}
+	}
+	return sum;
+}
+
+// Compares the cost queries through the virtual System interface with the same calls on the final ComputationBasedSystem,
+// which inline, and with the CostTable the evaluator uses
+void test_system_dispatch(int seed, int graph_size, int runs, Configuration config) {
+	RandomStreams const streams(seed);
+	Xoshiro256 graph_rng = streams.stream("graph");
+	ComputationBasedSystem system(generate_random_series_parallel_graph(graph_rng, graph_size), create_platform(nbr_fpgas(config)));
+	System const* volatile virtual_system = &system; // Hides the dynamic type from the optimizer, as for a mapper
+	CostTable const costs(system);
+
+	auto const measure = [runs](auto const& sum) {
+		Time result = 0;
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		for (int run = 0; run < runs; ++run) {
+			result += sum();
+		}
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		return std::make_pair(result / runs, std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / runs);
+	};
+	auto const [virtual_sum, virtual_us] = measure([&] { return sum_system_costs<System>(*virtual_system); });
+	auto const [final_sum, final_us] = measure([&] { return sum_system_costs(system); });
+	auto const [table_sum, table_us] = measure([&] { return sum_table_costs(system, costs); });
+
+	std::cout << "Configuration " << label(config) << ", " << graph_size << " tasks, " << runs << " runs (Seed " << seed << ")" << std::endl;
+	std::cout << "Virtual System:         sum " << virtual_sum << ", " << virtual_us << " us per run" << std::endl;
+	std::cout << "ComputationBasedSystem: sum " << final_sum << ", " << final_us << " us per run" << std::endl;
+	std::cout << "CostTable:              sum " << table_sum << ", " << table_us << " us per run" << std::endl;
 }
\ No newline at end of file
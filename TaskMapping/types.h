@@ -6,4 +6,9 @@ typedef unsigned DataSize;
 
 typedef double Time;
 typedef double ScaleFactor;
-typedef double Area;
\ No newline at end of file
+typedef double Area;
+
+typedef unsigned TaskId;
+typedef unsigned EdgeId;
+
+typedef unsigned long long DeviceMask; // Bit i stands for the device with Device::get_id() == i, see Platform::add_device
\ No newline at end of file